@@ -1,5 +1,7 @@
 use std::env;
-use std::path::PathBuf;
+use std::fmt::Write as _;
+use std::fs;
+use std::path::{Path, PathBuf};
 use std::process::Command;
 
 fn get_pkg_config_cflags(lib: &str) -> Vec<String> {
@@ -23,10 +25,72 @@ fn get_pkg_config_cflags(lib: &str) -> Vec<String> {
         .collect()
 }
 
+/// Sorted list of files in `dir` with the given extension
+fn files_with_extension(dir: &Path, ext: &str) -> Vec<PathBuf> {
+    let mut files: Vec<PathBuf> = fs::read_dir(dir)
+        .unwrap_or_else(|e| panic!("Failed to read {}: {}", dir.display(), e))
+        .filter_map(|entry| entry.ok().map(|e| e.path()))
+        .filter(|path| path.extension().map_or(false, |e| e == ext))
+        .collect();
+    files.sort();
+    files
+}
+
+/// Escape a JS source file as a C string literal, one source line per
+/// literal chunk so the generated header stays readable.
+fn c_string_literal(source: &str) -> String {
+    let mut out = String::from("\"");
+    for byte in source.bytes() {
+        match byte {
+            b'\\' => out.push_str("\\\\"),
+            b'"' => out.push_str("\\\""),
+            // Avoid accidental trigraphs
+            b'?' => out.push_str("\\?"),
+            b'\n' => out.push_str("\\n\"\n    \""),
+            b'\r' | b'\t' | 0x20..=0x7e => out.push(byte as char),
+            // Always three octal digits, so a following digit can't extend it
+            _ => write!(out, "\\{:03o}", byte).unwrap(),
+        }
+    }
+    out.push('"');
+    out
+}
+
+/// Embed inject/probes/*.js into a generated probes.h as the
+/// `spy_probe_sources` table (see struct spy_probe_source in inject/spy.h).
+fn generate_probes_header(probes_dir: &Path, header: &Path) {
+    let mut out = String::from("/* Generated by build.rs from the inject/probes scripts — do not edit */\n\n");
+    let mut names = Vec::new();
+
+    for path in files_with_extension(probes_dir, "js") {
+        let name = path.file_stem().unwrap().to_str().unwrap().to_string();
+        let source = fs::read_to_string(&path)
+            .unwrap_or_else(|e| panic!("Failed to read {}: {}", path.display(), e));
+        writeln!(
+            out,
+            "static const char probe_{}_js[] =\n    {};\n",
+            name.replace('-', "_"),
+            c_string_literal(&source)
+        )
+        .unwrap();
+        names.push(name);
+    }
+
+    out.push_str("static const struct spy_probe_source spy_probe_sources[] = {\n");
+    for name in &names {
+        writeln!(out, "    {{\"{}\", probe_{}_js}},", name, name.replace('-', "_")).unwrap();
+    }
+    out.push_str("};\n");
+
+    fs::write(header, out)
+        .unwrap_or_else(|e| panic!("Failed to write {}: {}", header.display(), e));
+}
+
 fn main() {
     let out_dir = PathBuf::from(env::var("OUT_DIR").unwrap());
     let manifest_dir = PathBuf::from(env::var("CARGO_MANIFEST_DIR").unwrap());
-    let spy_c = manifest_dir.join("inject").join("spy.c");
+    let inject_dir = manifest_dir.join("inject");
+    let sources = files_with_extension(&inject_dir, "c");
 
     // Get the target profile output directory (where the final binary goes)
     // OUT_DIR is something like target/release/build/tauri-spy-xxx/out
@@ -48,14 +112,18 @@ fn main() {
     cflags.sort();
     cflags.dedup();
 
-    // Compile spy.c into libspy.so
+    // Embed the page probes for channel.c
+    generate_probes_header(&inject_dir.join("probes"), &out_dir.join("probes.h"));
+
+    // Compile inject/*.c into libspy.so
     let mut gcc_args: Vec<String> = vec![
         "-shared".to_string(),
         "-fPIC".to_string(),
         "-o".to_string(),
         output.to_str().unwrap().to_string(),
-        spy_c.to_str().unwrap().to_string(),
     ];
+    gcc_args.extend(sources.iter().map(|s| s.to_str().unwrap().to_string()));
+    gcc_args.push(format!("-I{}", out_dir.display()));
     gcc_args.extend(cflags);
     gcc_args.extend([
         "-ldl".to_string(),
@@ -70,10 +138,10 @@ fn main() {
         .expect("Failed to run gcc — is gcc installed?");
 
     if !status.success() {
-        panic!("Failed to compile inject/spy.c into libspy.so");
+        panic!("Failed to compile inject/*.c into libspy.so");
     }
 
-    println!("cargo:rerun-if-changed=inject/spy.c");
+    println!("cargo:rerun-if-changed=inject");
     println!(
         "cargo:warning=libspy.so built at {}",
         output.display()
@@ -0,0 +1,272 @@
+/*
+ * channel.c — page-to-libspy metrics channel
+ *
+ * Every user content manager libspy sees — through the app's first
+ * add_script() call or through its webview — gets a "tauriSpy" script
+ * message handler plus a set of document-start user scripts: the channel
+ * itself (probes/channel.js, which exposes window.__tauriSpy) and whichever
+ * page probes were selected. Probes batch their records in the page; each
+ * message carries one JSON object per line and is appended to the report by
+ * the recorder.
+ *
+ * Probes are selected with TAURI_SPY_PROBES (comma-separated names, or
+ * "all"). The channel itself and a few cheap built-in probes are always
+ * installed.
+ */
+
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "spy.h"
+
+/* Generated by build.rs; needs struct spy_probe_source from spy.h */
+#include "probes.h"
+
+#define SPY_HANDLER_NAME "tauriSpy"
+
+/* Page probes installed on every webview, whatever TAURI_SPY_PROBES says */
+static const char *const builtin_probes[] = {
+    "channel",      /* window.__tauriSpy itself; must come first */
+    "init-scripts", /* timing for userscripts.c */
+};
+
+static int next_webview_id = 0;
+
+static char **selected_probes = NULL;
+static int probes_parsed = 0;
+
+/* Real function pointers — resolved via dlsym */
+typedef void (*load_uri_fn)(WebKitWebView *, const gchar *);
+static load_uri_fn real_load_uri = NULL;
+
+typedef void (*load_html_fn)(WebKitWebView *, const gchar *, const gchar *);
+static load_html_fn real_load_html = NULL;
+
+/*
+ * Stable small integer per webview, in discovery order. Stored on the
+ * GObject so every module agrees on the numbering.
+ */
+int spy_webview_id(WebKitWebView *view) {
+  gpointer stored = g_object_get_data(G_OBJECT(view), "tauri-spy-webview-id");
+  if (stored)
+    return GPOINTER_TO_INT(stored) - 1;
+
+  int id = next_webview_id++;
+  g_object_set_data(G_OBJECT(view), "tauri-spy-webview-id",
+                    GINT_TO_POINTER(id + 1));
+  return id;
+}
+
+/*
+ * Check TAURI_SPY_PROBES for a probe name. Covers page probes and the native
+ * ones that are too costly to run unasked.
+ */
+int spy_probe_enabled(const char *name) {
+  if (!probes_parsed) {
+    probes_parsed = 1;
+    const char *env = getenv("TAURI_SPY_PROBES");
+    if (env && *env)
+      selected_probes = g_strsplit(env, ",", -1);
+  }
+
+  if (!selected_probes)
+    return 0;
+
+  for (char **p = selected_probes; *p; p++) {
+    const char *probe = g_strstrip(*p);
+    if (strcmp(probe, "all") == 0 || strcmp(probe, name) == 0)
+      return 1;
+  }
+  return 0;
+}
+
+static const struct spy_probe_source *find_probe(const char *name) {
+  for (gsize i = 0; i < G_N_ELEMENTS(spy_probe_sources); i++) {
+    if (strcmp(spy_probe_sources[i].name, name) == 0)
+      return &spy_probe_sources[i];
+  }
+  return NULL;
+}
+
+static int is_builtin_probe(const char *name) {
+  for (gsize i = 0; i < G_N_ELEMENTS(builtin_probes); i++) {
+    if (strcmp(builtin_probes[i], name) == 0)
+      return 1;
+  }
+  return 0;
+}
+
+/*
+ * The channel and the other built-in probes first, then every selected page
+ * probe.
+ */
+static GList *active_probes(void) {
+  GList *probes = NULL;
+  for (gsize i = 0; i < G_N_ELEMENTS(builtin_probes); i++) {
+    const struct spy_probe_source *probe = find_probe(builtin_probes[i]);
+    if (probe)
+      probes = g_list_append(probes, (gpointer)probe);
+  }
+
+  for (gsize i = 0; i < G_N_ELEMENTS(spy_probe_sources); i++) {
+    const struct spy_probe_source *probe = &spy_probe_sources[i];
+    if (!is_builtin_probe(probe->name) && spy_probe_enabled(probe->name))
+      probes = g_list_append(probes, (gpointer)probe);
+  }
+  return probes;
+}
+
+/*
+ * Signal: script-message-received::tauriSpy — one batch from the page.
+ */
+static void on_script_message(WebKitUserContentManager *manager,
+                              WebKitJavascriptResult *result, gpointer data) {
+  (void)data;
+
+  if (!spy_recorder_active())
+    return;
+
+  /* Set by spy_channel_attach() once the manager's webview is known */
+  gpointer stored =
+      g_object_get_data(G_OBJECT(manager), "tauri-spy-webview-id");
+  int webview = stored ? GPOINTER_TO_INT(stored) - 1 : -1;
+
+  JSCValue *value = webkit_javascript_result_get_js_value(result);
+  if (!value || !jsc_value_is_string(value))
+    return;
+
+  char *batch = jsc_value_to_string(value);
+  if (!batch)
+    return;
+
+  char *line = batch;
+  while (*line) {
+    char *end = strchr(line, '\n');
+    gsize length = end ? (gsize)(end - line) : strlen(line);
+    spy_record_page(webview, line, length);
+    if (!end)
+      break;
+    line = end + 1;
+  }
+  spy_recorder_flush();
+
+  g_free(batch);
+}
+
+/*
+ * Register the message handler and the probe scripts on a user content
+ * manager (once per manager). userscripts.c calls this before the app's own
+ * first script is registered, so probes that wrap page globals run ahead of
+ * Tauri's init scripts.
+ */
+void spy_channel_install(WebKitUserContentManager *manager) {
+  if (g_object_get_data(G_OBJECT(manager), "tauri-spy-channel"))
+    return;
+  g_object_set_data(G_OBJECT(manager), "tauri-spy-channel",
+                    GINT_TO_POINTER(1));
+
+  g_signal_connect(manager, "script-message-received::" SPY_HANDLER_NAME,
+                   G_CALLBACK(on_script_message), NULL);
+  if (!webkit_user_content_manager_register_script_message_handler(
+          manager, SPY_HANDLER_NAME)) {
+    fprintf(stderr, "[tauri-spy] WARNING: Could not register the "
+                    "\"" SPY_HANDLER_NAME "\" message handler\n");
+  }
+  spy_console_install(manager);
+
+  GList *probes = active_probes();
+  for (GList *l = probes; l != NULL; l = l->next) {
+    const struct spy_probe_source *probe = l->data;
+    spy_add_user_script_untraced(manager, probe->source);
+  }
+  g_list_free(probes);
+}
+
+/*
+ * Document-start scripts only apply from the next navigation on. When the
+ * webview is found with a page already loaded, run them in it right away;
+ * the probes' claim() guard keeps a later document-start run from doubling
+ * up.
+ */
+static void run_probes_now(WebKitWebView *view, GList *probes) {
+  for (GList *l = probes; l != NULL; l = l->next) {
+    const struct spy_probe_source *probe = l->data;
+    spy_evaluate_javascript_untraced(view, probe->source);
+  }
+}
+
+/*
+ * Install the channel and selected probes on a webview (once per webview).
+ * Webviews sharing a user content manager share one handler, so their
+ * records are reported under the first webview's id.
+ */
+void spy_channel_attach(WebKitWebView *view) {
+  if (g_object_get_data(G_OBJECT(view), "tauri-spy-channel"))
+    return;
+  g_object_set_data(G_OBJECT(view), "tauri-spy-channel", GINT_TO_POINTER(1));
+
+  int id = spy_webview_id(view);
+  spy_windows_track(view);
+  WebKitUserContentManager *manager =
+      webkit_web_view_get_user_content_manager(view);
+  if (!manager)
+    return;
+
+  if (!g_object_get_data(G_OBJECT(manager), "tauri-spy-webview-id")) {
+    g_object_set_data(G_OBJECT(manager), "tauri-spy-webview-id",
+                      GINT_TO_POINTER(id + 1));
+  }
+  spy_channel_install(manager);
+
+  GList *probes = active_probes();
+  if (webkit_web_view_get_uri(view))
+    run_probes_now(view, probes);
+
+  fprintf(stderr,
+          "[tauri-spy] Metrics channel attached to WebKitWebView %p "
+          "(webview %d, %u probe script(s))\n",
+          (void *)view, id, g_list_length(probes));
+  g_list_free(probes);
+}
+
+/*
+ * Hook: webkit_web_view_load_uri() — wry loads the app's first page through
+ * this, usually before the webview is reachable from any toplevel. Attaching
+ * here lets document-start probes see the very first navigation.
+ */
+void webkit_web_view_load_uri(WebKitWebView *web_view, const gchar *uri) {
+  if (!real_load_uri) {
+    real_load_uri = (load_uri_fn)dlsym(RTLD_NEXT, "webkit_web_view_load_uri");
+    if (!real_load_uri) {
+      fprintf(stderr, "[tauri-spy] FATAL: Could not find real "
+                      "webkit_web_view_load_uri()\n");
+      return;
+    }
+  }
+
+  spy_channel_attach(web_view);
+  real_load_uri(web_view, uri);
+}
+
+/*
+ * Hook: webkit_web_view_load_html() — same as above for apps that start from
+ * an inline HTML document.
+ */
+void webkit_web_view_load_html(WebKitWebView *web_view, const gchar *content,
+                               const gchar *base_uri) {
+  if (!real_load_html) {
+    real_load_html =
+        (load_html_fn)dlsym(RTLD_NEXT, "webkit_web_view_load_html");
+    if (!real_load_html) {
+      fprintf(stderr, "[tauri-spy] FATAL: Could not find real "
+                      "webkit_web_view_load_html()\n");
+      return;
+    }
+  }
+
+  spy_channel_attach(web_view);
+  real_load_html(web_view, content, base_uri);
+}
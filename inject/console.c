@@ -0,0 +1,140 @@
+/*
+ * console.c — console output files for the "console" probe
+ *
+ * The console probe posts the formatted console lines of its page to a
+ * "tauriSpyConsole" script message handler, once per second. Each webview
+ * gets its own file next to the report, "<report>.console-<webview>.log".
+ * A file that grows past CONSOLE_ROTATE_BYTES is renamed to ".1", replacing
+ * the previous one, and started afresh; a logging storm can fill at most
+ * twice that much disk.
+ *
+ * Opening a file writes a "console_file" record with its path, and every
+ * rotation a "console_rotated" record, so the report can point at them.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "spy.h"
+
+#define SPY_CONSOLE_HANDLER_NAME "tauriSpyConsole"
+
+/* Size at which a console file is rotated */
+#define CONSOLE_ROTATE_BYTES (16 * 1024 * 1024)
+
+struct console_file {
+  FILE *file;
+  char *path;
+  gsize bytes;
+  guint rotations;
+};
+
+/* Webview id -> struct console_file, touched on the main thread only */
+static GHashTable *console_files = NULL;
+
+static void console_file_free(gpointer data) {
+  struct console_file *cf = data;
+  if (cf->file)
+    fclose(cf->file);
+  g_free(cf->path);
+  g_free(cf);
+}
+
+static struct console_file *console_file_for(int webview) {
+  if (!console_files) {
+    console_files = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                                          console_file_free);
+  }
+
+  gpointer key = GINT_TO_POINTER(webview);
+  struct console_file *cf = g_hash_table_lookup(console_files, key);
+  if (cf)
+    return cf;
+
+  cf = g_new0(struct console_file, 1);
+  cf->path = g_strdup_printf("%s.console-%d.log", getenv("TAURI_SPY_REPORT"),
+                             webview);
+  cf->file = fopen(cf->path, "w");
+  if (cf->file) {
+    char *path = spy_json_string(cf->path);
+    spy_record(webview, "console_file", "\"path\":%s", path);
+    g_free(path);
+  } else {
+    fprintf(stderr, "[tauri-spy] WARNING: Could not open console file %s\n",
+            cf->path);
+  }
+  g_hash_table_insert(console_files, key, cf);
+  return cf;
+}
+
+static void rotate(struct console_file *cf, int webview) {
+  char *previous = g_strdup_printf("%s.1", cf->path);
+  fclose(cf->file);
+  if (rename(cf->path, previous) != 0) {
+    fprintf(stderr, "[tauri-spy] WARNING: Could not rotate %s: %s\n",
+            cf->path, strerror(errno));
+  }
+  g_free(previous);
+
+  cf->file = fopen(cf->path, "w");
+  cf->bytes = 0;
+  cf->rotations++;
+  spy_record(webview, "console_rotated", "\"rotations\":%u", cf->rotations);
+}
+
+/*
+ * Signal: script-message-received::tauriSpyConsole — one second of console
+ * lines from the page.
+ */
+static void on_console_message(WebKitUserContentManager *manager,
+                               WebKitJavascriptResult *result, gpointer data) {
+  (void)data;
+
+  /* Set by spy_channel_attach() once the manager's webview is known */
+  gpointer stored =
+      g_object_get_data(G_OBJECT(manager), "tauri-spy-webview-id");
+  int webview = stored ? GPOINTER_TO_INT(stored) - 1 : -1;
+
+  JSCValue *value = webkit_javascript_result_get_js_value(result);
+  if (!value || !jsc_value_is_string(value))
+    return;
+
+  struct console_file *cf = console_file_for(webview);
+  if (!cf->file)
+    return;
+
+  char *lines = jsc_value_to_string(value);
+  if (!lines)
+    return;
+
+  gsize length = strlen(lines);
+  fwrite(lines, 1, length, cf->file);
+  fputc('\n', cf->file);
+  fflush(cf->file);
+  cf->bytes += length + 1;
+  g_free(lines);
+
+  if (cf->bytes >= CONSOLE_ROTATE_BYTES)
+    rotate(cf, webview);
+}
+
+/*
+ * Register the console handler on a user content manager, if the "console"
+ * probe was selected. Called from spy_channel_install(), once per manager.
+ */
+void spy_console_install(WebKitUserContentManager *manager) {
+  if (!spy_recorder_active() || !spy_probe_enabled("console"))
+    return;
+
+  g_signal_connect(manager,
+                   "script-message-received::" SPY_CONSOLE_HANDLER_NAME,
+                   G_CALLBACK(on_console_message), NULL);
+  if (!webkit_user_content_manager_register_script_message_handler(
+          manager, SPY_CONSOLE_HANDLER_NAME)) {
+    fprintf(stderr, "[tauri-spy] WARNING: Could not register the "
+                    "\"" SPY_CONSOLE_HANDLER_NAME "\" message handler\n");
+  }
+}
@@ -0,0 +1,381 @@
+/*
+ * evaluate.c — backend-to-frontend JavaScript evaluation tracing
+ *
+ * Tauri delivers events, IPC responses and channel messages to the page by
+ * evaluating small scripts on the webview. This unit interposes WebKit's
+ * evaluation entry points and reports, per webview and per second, the call
+ * rate, script bytes and completion latency (from the call until WebKit hands
+ * the result back to the UI process). The one-second flush runs only while
+ * there is traffic: it stops after a quiet second and the next call or
+ * completion starts it again, so an idle app is not woken for it.
+ *
+ * Scripts that deliver a Tauri callback — channel messages, event payloads —
+ * are also counted per callback id, which the ipc-channels page probe
+ * reports as the channel id.
+ *
+ * Hooks:
+ *   - webkit_web_view_evaluate_javascript() (WebKitGTK 2.40+)
+ *   - webkit_web_view_run_javascript() (deprecated, still used by older wry)
+ */
+
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "spy.h"
+
+/* Per-webview counters for the current one-second window */
+struct eval_stats {
+  guint calls;
+  guint run_calls;
+  gint64 bytes;
+  gsize max_bytes;
+  guint completed;
+  gint64 latency_sum_us;
+  gint64 latency_max_us;
+  guint pending;
+};
+
+/* Per-(webview, Tauri callback id) counters for the current window */
+struct callback_stats {
+  int webview;
+  guint32 callback;
+  guint calls;
+  guint fetches;
+  gint64 bytes;
+  guint completed;
+  gint64 latency_sum_us;
+  gint64 latency_max_us;
+};
+
+/* One in-flight evaluation, carried through our completion trampoline */
+struct pending_eval {
+  GAsyncReadyCallback callback;
+  gpointer user_data;
+  gint64 start_us;
+  int webview;
+  gint64 tauri_callback;
+};
+
+/* Callback ids tracked at once; deliveries beyond that are only counted */
+#define MAX_TRACKED_CALLBACKS 1024
+
+/* How far into a script to look for a callback invocation */
+#define CALLBACK_SCAN_BYTES 512
+
+static GHashTable *stats_by_webview = NULL;
+static GHashTable *stats_by_callback = NULL;
+static guint flush_source = 0;
+
+/* Real function pointers — resolved via dlsym */
+typedef void (*evaluate_javascript_fn)(WebKitWebView *, const char *, gssize,
+                                       const char *, const char *,
+                                       GCancellable *, GAsyncReadyCallback,
+                                       gpointer);
+static evaluate_javascript_fn real_evaluate_javascript = NULL;
+
+typedef void (*run_javascript_fn)(WebKitWebView *, const gchar *,
+                                  GCancellable *, GAsyncReadyCallback,
+                                  gpointer);
+static run_javascript_fn real_run_javascript = NULL;
+
+static struct eval_stats *stats_for(int webview) {
+  if (!stats_by_webview)
+    stats_by_webview =
+        g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+
+  struct eval_stats *stats =
+      g_hash_table_lookup(stats_by_webview, GINT_TO_POINTER(webview));
+  if (!stats) {
+    stats = g_new0(struct eval_stats, 1);
+    g_hash_table_insert(stats_by_webview, GINT_TO_POINTER(webview), stats);
+  }
+  return stats;
+}
+
+/*
+ * Tauri runs callbacks as window.__TAURI_INTERNALS__.runCallback(<id>, ...)
+ * or, in older releases, window['_<id>'](...). Channel payloads too large to
+ * inline are fetched through the __TAURI_CHANNEL__ plugin first and then
+ * handed to runCallback. Returns the callback id, or -1.
+ */
+static gint64 tauri_callback_id(const char *script, gsize length,
+                                int *is_fetch) {
+  static const char *const prefixes[] = {"runCallback(", "window['_",
+                                         "window[\"_"};
+  gsize scan = MIN(length, CALLBACK_SCAN_BYTES);
+
+  *is_fetch = g_strstr_len(script, scan, "__TAURI_CHANNEL__") != NULL;
+
+  for (gsize i = 0; i < G_N_ELEMENTS(prefixes); i++) {
+    const char *hit = g_strstr_len(script, scan, prefixes[i]);
+    if (!hit)
+      continue;
+
+    char *end = NULL;
+    guint64 id = g_ascii_strtoull(hit + strlen(prefixes[i]), &end, 10);
+    if (end && end != hit + strlen(prefixes[i]) && id <= G_MAXUINT32)
+      return (gint64)id;
+  }
+  return -1;
+}
+
+static gint64 callback_key(int webview, guint32 callback) {
+  return ((gint64)webview << 32) | callback;
+}
+
+static struct callback_stats *callback_stats_for(int webview,
+                                                 gint64 callback) {
+  if (callback < 0)
+    return NULL;
+
+  if (!stats_by_callback)
+    stats_by_callback =
+        g_hash_table_new_full(g_int64_hash, g_int64_equal, g_free, g_free);
+
+  gint64 key = callback_key(webview, (guint32)callback);
+  struct callback_stats *stats = g_hash_table_lookup(stats_by_callback, &key);
+  if (!stats) {
+    if (g_hash_table_size(stats_by_callback) >= MAX_TRACKED_CALLBACKS)
+      return NULL;
+    stats = g_new0(struct callback_stats, 1);
+    stats->webview = webview;
+    stats->callback = (guint32)callback;
+    gint64 *stored_key = g_new(gint64, 1);
+    *stored_key = key;
+    g_hash_table_insert(stats_by_callback, stored_key, stats);
+  }
+  return stats;
+}
+
+static void flush_callback_stats(void) {
+  if (!stats_by_callback)
+    return;
+
+  GHashTableIter iter;
+  gpointer value;
+  g_hash_table_iter_init(&iter, stats_by_callback);
+  while (g_hash_table_iter_next(&iter, NULL, &value)) {
+    struct callback_stats *stats = value;
+    if (stats->calls == 0 && stats->completed == 0) {
+      /* Idle for a whole window — forget it, ids are not reused */
+      g_hash_table_iter_remove(&iter);
+      continue;
+    }
+
+    spy_record(stats->webview, "eval_callback",
+               "\"callback\":%u,\"calls\":%u,\"fetches\":%u,\"bytes\":%"
+               G_GINT64_FORMAT ",\"completed\":%u"
+               ",\"latency_avg_us\":%" G_GINT64_FORMAT
+               ",\"latency_max_us\":%" G_GINT64_FORMAT,
+               stats->callback, stats->calls, stats->fetches, stats->bytes,
+               stats->completed,
+               stats->completed ? stats->latency_sum_us / stats->completed : 0,
+               stats->latency_max_us);
+
+    int webview = stats->webview;
+    guint32 callback = stats->callback;
+    memset(stats, 0, sizeof(*stats));
+    stats->webview = webview;
+    stats->callback = callback;
+  }
+}
+
+static gboolean flush_stats(gpointer data) {
+  (void)data;
+
+  gboolean traffic = FALSE;
+  GHashTableIter iter;
+  gpointer key, value;
+  g_hash_table_iter_init(&iter, stats_by_webview);
+  while (g_hash_table_iter_next(&iter, &key, &value)) {
+    struct eval_stats *stats = value;
+    if (stats->calls == 0 && stats->completed == 0)
+      continue;
+    traffic = TRUE;
+
+    spy_record(GPOINTER_TO_INT(key), "eval",
+               "\"calls\":%u,\"run_calls\":%u,\"bytes\":%" G_GINT64_FORMAT
+               ",\"max_bytes\":%" G_GSIZE_FORMAT ",\"completed\":%u"
+               ",\"latency_avg_us\":%" G_GINT64_FORMAT
+               ",\"latency_max_us\":%" G_GINT64_FORMAT ",\"pending\":%u",
+               stats->calls, stats->run_calls, stats->bytes, stats->max_bytes,
+               stats->completed,
+               stats->completed ? stats->latency_sum_us / stats->completed : 0,
+               stats->latency_max_us, stats->pending);
+
+    /* Keep the in-flight count; it spans windows */
+    guint pending = stats->pending;
+    memset(stats, 0, sizeof(*stats));
+    stats->pending = pending;
+  }
+
+  flush_callback_stats();
+  if (traffic)
+    return TRUE; /* Keep flushing */
+
+  flush_source = 0;
+  return FALSE;
+}
+
+static void schedule_flush(void) {
+  schedule_flush();
+}
+
+/*
+ * Count a call and wrap its completion. Evaluations issued without a
+ * callback get one too, so fire-and-forget event deliveries are timed as
+ * well; WebKit then sends their (ignored) result back to the UI process.
+ */
+static struct pending_eval *trace_call(WebKitWebView *view,
+                                       const char *script, gsize length,
+                                       int legacy, GAsyncReadyCallback callback,
+                                       gpointer user_data) {
+  int webview = spy_webview_id(view);
+  struct eval_stats *stats = stats_for(webview);
+  stats->calls++;
+  if (legacy)
+    stats->run_calls++;
+  stats->bytes += length;
+  if (length > stats->max_bytes)
+    stats->max_bytes = length;
+  stats->pending++;
+
+  int is_fetch = 0;
+  gint64 tauri_callback = tauri_callback_id(script, length, &is_fetch);
+  struct callback_stats *cb_stats = callback_stats_for(webview, tauri_callback);
+  if (cb_stats) {
+    cb_stats->calls++;
+    if (is_fetch)
+      cb_stats->fetches++;
+    cb_stats->bytes += length;
+  }
+
+  if (!flush_source)
+    flush_source = g_timeout_add_seconds(1, flush_stats, NULL);
+
+  struct pending_eval *pending = g_new0(struct pending_eval, 1);
+  pending->callback = callback;
+  pending->user_data = user_data;
+  pending->start_us = spy_now_us();
+  pending->webview = webview;
+  pending->tauri_callback = tauri_callback;
+  return pending;
+}
+
+static void on_eval_finished(GObject *source, GAsyncResult *result,
+                             gpointer data) {
+  struct pending_eval *pending = data;
+  gint64 latency = spy_now_us() - pending->start_us;
+
+  struct eval_stats *stats = stats_for(pending->webview);
+  stats->completed++;
+  stats->latency_sum_us += latency;
+  if (latency > stats->latency_max_us)
+    stats->latency_max_us = latency;
+  if (stats->pending > 0)
+    stats->pending--;
+  schedule_flush();
+
+  struct callback_stats *cb_stats =
+      callback_stats_for(pending->webview, pending->tauri_callback);
+  if (cb_stats) {
+    cb_stats->completed++;
+    cb_stats->latency_sum_us += latency;
+    if (latency > cb_stats->latency_max_us)
+      cb_stats->latency_max_us = latency;
+  }
+
+  /* The caller's *_finish() only needs the source object and result */
+  if (pending->callback)
+    pending->callback(source, result, pending->user_data);
+  g_free(pending);
+}
+
+static void ensure_real_evaluate_javascript(void) {
+  if (!real_evaluate_javascript) {
+    real_evaluate_javascript = (evaluate_javascript_fn)dlsym(
+        RTLD_NEXT, "webkit_web_view_evaluate_javascript");
+  }
+}
+
+static void ensure_real_run_javascript(void) {
+  if (!real_run_javascript) {
+    real_run_javascript =
+        (run_javascript_fn)dlsym(RTLD_NEXT, "webkit_web_view_run_javascript");
+  }
+}
+
+/*
+ * Run a script without tracing it — for libspy's own injections, which
+ * should not show up as backend traffic.
+ */
+void spy_evaluate_javascript_untraced(WebKitWebView *view, const char *script) {
+  ensure_real_evaluate_javascript();
+  if (real_evaluate_javascript) {
+    real_evaluate_javascript(view, script, -1, NULL, NULL, NULL, NULL, NULL);
+    return;
+  }
+
+  ensure_real_run_javascript();
+  if (real_run_javascript)
+    real_run_javascript(view, script, NULL, NULL, NULL);
+}
+
+/*
+ * Hook: webkit_web_view_evaluate_javascript()
+ */
+void webkit_web_view_evaluate_javascript(WebKitWebView *web_view,
+                                         const char *script, gssize length,
+                                         const char *world_name,
+                                         const char *source_uri,
+                                         GCancellable *cancellable,
+                                         GAsyncReadyCallback callback,
+                                         gpointer user_data) {
+  ensure_real_evaluate_javascript();
+  if (!real_evaluate_javascript) {
+    fprintf(stderr, "[tauri-spy] FATAL: Could not find real "
+                    "webkit_web_view_evaluate_javascript()\n");
+    return;
+  }
+
+  if (!spy_recorder_active()) {
+    real_evaluate_javascript(web_view, script, length, world_name, source_uri,
+                             cancellable, callback, user_data);
+    return;
+  }
+
+  gsize bytes = length < 0 ? strlen(script) : (gsize)length;
+  struct pending_eval *pending =
+      trace_call(web_view, script, bytes, 0, callback, user_data);
+  real_evaluate_javascript(web_view, script, length, world_name, source_uri,
+                           cancellable, on_eval_finished, pending);
+}
+
+/*
+ * Hook: webkit_web_view_run_javascript()
+ */
+void webkit_web_view_run_javascript(WebKitWebView *web_view,
+                                    const gchar *script,
+                                    GCancellable *cancellable,
+                                    GAsyncReadyCallback callback,
+                                    gpointer user_data) {
+  ensure_real_run_javascript();
+  if (!real_run_javascript) {
+    fprintf(stderr, "[tauri-spy] FATAL: Could not find real "
+                    "webkit_web_view_run_javascript()\n");
+    return;
+  }
+
+  if (!spy_recorder_active()) {
+    real_run_javascript(web_view, script, cancellable, callback, user_data);
+    return;
+  }
+
+  struct pending_eval *pending =
+      trace_call(web_view, script, strlen(script), 1, callback, user_data);
+  real_run_javascript(web_view, script, cancellable, on_eval_finished,
+                      pending);
+}
@@ -0,0 +1,275 @@
+/*
+ * tauri-spy probe: animations
+ *
+ * Find CSS animations, transitions and Web Animations that animate
+ * properties the compositor can't run on its own. Animating transform,
+ * opacity or filter only recomposites; animating width or top re-runs
+ * layout every frame, and box-shadow or background-color repaint. Running
+ * animations are listed with document.getAnimations() whenever one starts;
+ * each is classified by the properties in its keyframes.
+ *
+ * While a layout or paint animation runs, a rAF loop measures frame
+ * intervals. Every second an "animations" record gives the frames any of
+ * them ran in and how many were dropped (longer than DROPPED_FRAME_MS), and
+ * the same per animation with its longest frame. Animations with the same
+ * selector, name and properties (a list of spinners) share one row.
+ *
+ * Computed will-change values are scanned through __tauriSpy.scanElements():
+ * each element promoted to its own layer holds a texture of about
+ * width * height * 4 bytes, and a "will_change" record lists the largest.
+ */
+(function () {
+  "use strict";
+
+  var spy = window.__tauriSpy;
+  if (!spy || !spy.claim("animations")) return;
+
+  var DROPPED_FRAME_MS = (1000 / 60) * 1.5;
+  var TOP_LAYERS = 20;
+
+  var COMPOSITED = /^(transform|opacity|filter|translate|rotate|scale|offset)/;
+  var LAYOUT = new RegExp(
+    "^(width|height|min-|max-|top|left|right|bottom|inset|margin|padding|" +
+      "border(-\\w+)?-width|font-size|line-height|letter-spacing|flex|gap|" +
+      "grid)"
+  );
+  var KEYFRAME_FIELDS = /^(offset|computedOffset|easing|composite)$/;
+
+  var classified = new WeakMap(); /* Animation -> entry | null */
+  var running = new Map(); /* Animation -> entry */
+  var stopped = new Set(); /* Entries with frames not yet flushed */
+  var entries = Object.create(null); /* selector, name, properties -> entry */
+  var frames = 0;
+  var dropped = 0;
+  var scanPending = false;
+  var looping = false;
+  var lastFrame = null;
+  var timer = null;
+  var lastLayers = "";
+
+  function describe(element) {
+    var parts = [];
+    for (var e = element; e && e.nodeType === 1 && parts.length < 3; ) {
+      var name = e.localName;
+      if (e.id) {
+        parts.unshift(name + "#" + e.id);
+        break;
+      }
+      var className = e.getAttribute("class");
+      if (className) {
+        name += "." + className.trim().split(/\s+/).slice(0, 2).join(".");
+      }
+      parts.unshift(name);
+      e = e.parentElement;
+    }
+    return parts.join(" > ");
+  }
+
+  function hyphenate(property) {
+    return property.replace(/[A-Z]/g, function (c) {
+      return "-" + c.toLowerCase();
+    });
+  }
+
+  function propertiesOf(effect) {
+    var seen = Object.create(null);
+    var keyframes = effect.getKeyframes();
+    for (var i = 0; i < keyframes.length; i++) {
+      for (var key in keyframes[i]) {
+        if (!KEYFRAME_FIELDS.test(key)) seen[hyphenate(key)] = true;
+      }
+    }
+    return Object.keys(seen).sort();
+  }
+
+  /* "layout", "paint", or null when everything can be composited */
+  function cost(properties) {
+    var result = null;
+    for (var i = 0; i < properties.length; i++) {
+      if (LAYOUT.test(properties[i])) return "layout";
+      if (!COMPOSITED.test(properties[i])) result = "paint";
+    }
+    return result;
+  }
+
+  function classify(animation) {
+    var effect = animation.effect;
+    if (!effect || !effect.target || !effect.getKeyframes) return null;
+
+    var properties = propertiesOf(effect);
+    var trigger = cost(properties);
+    if (!trigger) return null;
+
+    var type = "animate()";
+    var name = animation.id || "";
+    if (animation.animationName !== undefined) {
+      type = "css-animation";
+      name = animation.animationName;
+    } else if (animation.transitionProperty !== undefined) {
+      type = "css-transition";
+      name = animation.transitionProperty;
+    }
+    var selector = describe(effect.target);
+    var key = [selector, type, name, properties.join(" ")].join("\n");
+    if (!entries[key]) {
+      entries[key] = {
+        selector: selector,
+        type: type,
+        name: name,
+        properties: properties,
+        trigger: trigger,
+        frames: 0,
+        dropped: 0,
+        maxFrameMs: 0,
+      };
+    }
+    return entries[key];
+  }
+
+  function frame(timestamp) {
+    var delta = lastFrame === null ? null : timestamp - lastFrame;
+    lastFrame = timestamp;
+
+    var counted = new Set();
+    running.forEach(function (entry, animation) {
+      if (animation.playState !== "running") {
+        running.delete(animation);
+        if (entry.frames) stopped.add(entry);
+        return;
+      }
+      if (delta === null || counted.has(entry)) return;
+      counted.add(entry);
+      entry.frames++;
+      if (delta > DROPPED_FRAME_MS) entry.dropped++;
+      if (delta > entry.maxFrameMs) entry.maxFrameMs = delta;
+    });
+    if (counted.size) {
+      frames++;
+      if (delta > DROPPED_FRAME_MS) dropped++;
+    }
+
+    if (!running.size) {
+      looping = false;
+      lastFrame = null;
+      return;
+    }
+    spy.raf(frame);
+  }
+
+  function scan() {
+    scanPending = false;
+    var animations = document.getAnimations();
+    for (var i = 0; i < animations.length; i++) {
+      var animation = animations[i];
+      if (animation.playState !== "running") continue;
+
+      var entry = classified.get(animation);
+      if (entry === undefined) {
+        entry = classify(animation);
+        classified.set(animation, entry);
+      }
+      if (entry) running.set(animation, entry);
+    }
+
+    if (running.size && !looping) {
+      looping = true;
+      spy.raf(frame);
+    }
+    if (running.size && !timer) timer = spy.setInterval(flush, 1000);
+  }
+
+  function scheduleScan() {
+    if (scanPending) return;
+    scanPending = true;
+    spy.setTimeout(scan, 0);
+  }
+
+  function flush() {
+    var rows = [];
+    var seen = stopped;
+    stopped = new Set();
+    running.forEach(function (entry) {
+      seen.add(entry);
+    });
+
+    seen.forEach(function (entry) {
+      if (!entry.frames) return;
+      rows.push([
+        entry.selector,
+        entry.type,
+        entry.name,
+        entry.properties.join(" "),
+        entry.trigger,
+        entry.frames,
+        entry.dropped,
+        spy.round(entry.maxFrameMs),
+      ]);
+      entry.frames = 0;
+      entry.dropped = 0;
+      entry.maxFrameMs = 0;
+    });
+
+    if (!rows.length) {
+      if (!running.size) {
+        spy.clearInterval(timer);
+        timer = null;
+      }
+      return;
+    }
+    spy.emit("animations", {
+      frames: frames,
+      dropped: dropped,
+      items: rows,
+    });
+    frames = 0;
+    dropped = 0;
+  }
+
+  function scanLayers(elements, limit) {
+    var ratio = window.devicePixelRatio || 1;
+    var layers = [];
+    var total = 0;
+    for (var i = 0; i < limit; i++) {
+      var value = getComputedStyle(elements[i]).willChange;
+      if (!value || value === "auto") continue;
+
+      var rect = elements[i].getBoundingClientRect();
+      var width = Math.round(rect.width * ratio);
+      var height = Math.round(rect.height * ratio);
+      var bytes = width * height * 4;
+      total += bytes;
+      layers.push([describe(elements[i]), value, width, height, bytes]);
+    }
+    layers.sort(function (a, b) {
+      return b[4] - a[4];
+    });
+
+    var signature = JSON.stringify(layers);
+    if (signature === lastLayers) return;
+    lastLayers = signature;
+    spy.emit("will_change", {
+      layers: layers.length,
+      bytes: total,
+      items: layers.slice(0, TOP_LAYERS),
+    });
+  }
+
+  /* A pending scan is left alone: pages that keep animating still get one */
+
+  var originalAnimate = Element.prototype.animate;
+  if (originalAnimate) {
+    Element.prototype.animate = function () {
+      var animation = originalAnimate.apply(this, arguments);
+      scheduleScan();
+      return animation;
+    };
+  }
+  document.addEventListener("animationstart", scheduleScan, true);
+  document.addEventListener("transitionrun", scheduleScan, true);
+
+  spy.scanElements(scanLayers, ["style", "class"]);
+
+  if (document.readyState === "complete") scheduleScan();
+  else window.addEventListener("load", scheduleScan);
+})();
+//# sourceURL=tauri-spy://probe/animations.js
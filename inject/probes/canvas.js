@@ -0,0 +1,282 @@
+/*
+ * tauri-spy probe: canvas
+ *
+ * Wrap every CanvasRenderingContext2D method and count calls per canvas and
+ * per frame. With software rendering (WebKitGTK without a GPU) each call
+ * rasterizes on the CPU, so canvas drawing often is most of a frame.
+ *
+ * Timing every call would cost more than most calls do, so one call in
+ * SAMPLE_EVERY per method and canvas is timed, and the others are
+ * estimated from it. Operations known to be expensive are always timed:
+ * getImageData() (a full pixel readback), draws while shadowBlur is set (a
+ * blur per shape) and drawImage() scaled by SCALE_RATIO or more in either
+ * direction. The first time one of them runs from a call site it is also
+ * reported on its own, as "canvas_expensive" with its stack.
+ *
+ * Once per second a "canvas" record carries, per canvas, the calls, frames
+ * drawn, calls in the busiest frame, estimated time, the top methods and the
+ * expensive operations. Only canvases drawn on since the previous record are
+ * kept in the list walked per frame and per record; the others are held
+ * weakly, so canvases the page drops can be collected.
+ */
+(function () {
+  "use strict";
+
+  var spy = window.__tauriSpy;
+  var Context = window.CanvasRenderingContext2D;
+  if (!spy || !Context || !spy.claim("canvas")) return;
+
+  var SAMPLE_EVERY = 16;
+  var SCALE_RATIO = 4;
+  var SCALE_MIN_PIXELS = 256 * 256;
+  var TOP_METHODS = 5;
+  var STACK_DEPTH = 6;
+
+  var DRAWS = new RegExp(
+    "^(fill|stroke|fillRect|strokeRect|fillText|strokeText|drawImage)$"
+  );
+  var NO_SHADOW = "rgba(0, 0, 0, 0)";
+
+  var now = spy.now;
+  var proto = Context.prototype;
+
+  var states = new WeakMap(); /* context -> state */
+  var active = []; /* States drawn on since the last flush */
+  var nextId = 0;
+  var reported = Object.create(null);
+  var looping = false;
+  var frames = 0;
+  var timer = null;
+
+  function describe(canvas) {
+    var name = "canvas";
+    if (canvas.id) return name + "#" + canvas.id;
+    var className = canvas.getAttribute && canvas.getAttribute("class");
+    if (className) {
+      name += "." + className.trim().split(/\s+/).slice(0, 2).join(".");
+    }
+    return name;
+  }
+
+  function emptyCounters(state) {
+    state.calls = 0;
+    state.frames = 0;
+    state.maxPerFrame = 0;
+    state.methods = Object.create(null);
+    state.getImageData = [0, 0, 0]; /* calls, ms, pixels */
+    state.shadow = [0, 0]; /* calls, ms */
+    state.scaled = [0, 0, 0]; /* calls, ms, max ratio */
+    return state;
+  }
+
+  function stateOf(context) {
+    var state = states.get(context);
+    if (!state) {
+      state = emptyCounters({
+        id: nextId++,
+        canvas: context.canvas,
+        frameCalls: 0,
+        listed: false,
+      });
+      states.set(context, state);
+    }
+    if (!state.listed) {
+      state.listed = true;
+      active.push(state);
+    }
+    return state;
+  }
+
+  function frame() {
+    var drew = false;
+    active.forEach(function (state) {
+      if (!state.frameCalls) return;
+      drew = true;
+      state.frames++;
+      if (state.frameCalls > state.maxPerFrame) {
+        state.maxPerFrame = state.frameCalls;
+      }
+      state.frameCalls = 0;
+    });
+    if (!drew) {
+      looping = false;
+      return;
+    }
+    frames++;
+    spy.raf(frame);
+  }
+
+  var round = spy.round;
+
+  function flush() {
+    var canvases = [];
+    active.forEach(function (state) {
+      if (!state.calls) return;
+      var methods = [];
+      var ms = 0;
+      for (var name in state.methods) {
+        var m = state.methods[name];
+        var sampled = m.calls - m.exactCalls;
+        var estimate = m.exactMs;
+        if (m.timed) estimate += (m.ms * sampled) / m.timed;
+        ms += estimate;
+        methods.push([name, m.calls, round(estimate)]);
+      }
+      methods.sort(function (a, b) {
+        return b[2] - a[2] || b[1] - a[1];
+      });
+
+      var canvas = state.canvas;
+      canvases.push({
+        canvas: state.id,
+        label: describe(canvas),
+        width: canvas.width,
+        height: canvas.height,
+        calls: state.calls,
+        frames: state.frames,
+        max_per_frame: state.maxPerFrame,
+        ms: round(ms),
+        methods: methods.slice(0, TOP_METHODS),
+        get_image_data: [
+          state.getImageData[0],
+          round(state.getImageData[1]),
+          state.getImageData[2],
+        ],
+        shadow: [state.shadow[0], round(state.shadow[1])],
+        scaled: [state.scaled[0], round(state.scaled[1]), state.scaled[2]],
+      });
+      emptyCounters(state);
+    });
+    /* Calls of a frame still being drawn are counted by the next frame() */
+    active = active.filter(function (state) {
+      state.listed = state.frameCalls > 0;
+      return state.listed;
+    });
+
+    if (!canvases.length) {
+      spy.clearInterval(timer);
+      timer = null;
+      return;
+    }
+    spy.emit("canvas", { frames: frames, canvases: canvases });
+    frames = 0;
+  }
+
+  function expensive(state, op, detail, ms) {
+    var stack = spy.stack(STACK_DEPTH);
+    var key = op + "\n" + (stack[0] || "");
+    if (reported[key]) return;
+    reported[key] = true;
+    spy.emit("canvas_expensive", {
+      canvas: state.id,
+      label: describe(state.canvas),
+      op: op,
+      detail: detail,
+      ms: round(ms),
+      site: stack[0] || null,
+      stack: stack,
+    });
+  }
+
+  /* Source and destination areas of a drawImage() call */
+  function scaleOf(args) {
+    var image = args[0];
+    var sw = image.naturalWidth || image.videoWidth || image.width || 0;
+    var sh = image.naturalHeight || image.videoHeight || image.height || 0;
+    var dw = sw;
+    var dh = sh;
+    if (args.length >= 9) {
+      sw = args[3];
+      sh = args[4];
+      dw = args[7];
+      dh = args[8];
+    } else if (args.length >= 5) {
+      dw = args[3];
+      dh = args[4];
+    }
+    var source = Math.abs(sw * sh);
+    var dest = Math.abs(dw * dh);
+    if (!source || !dest) return null;
+    if (Math.max(source, dest) < SCALE_MIN_PIXELS) return null;
+    var ratio = source > dest ? source / dest : dest / source;
+    return ratio >= SCALE_RATIO ? ratio : null;
+  }
+
+  function wrap(name, original) {
+    return function () {
+      var state = stateOf(this);
+      state.calls++;
+      state.frameCalls++;
+      if (!looping) {
+        looping = true;
+        spy.raf(frame);
+      }
+      if (!timer) timer = spy.setInterval(flush, 1000);
+
+      var m = state.methods[name];
+      if (!m) {
+        m = state.methods[name] = {
+          calls: 0,
+          timed: 0,
+          ms: 0,
+          exactCalls: 0,
+          exactMs: 0,
+        };
+      }
+      m.calls++;
+
+      var shadow =
+        DRAWS.test(name) &&
+        this.shadowBlur > 0 &&
+        this.shadowColor !== NO_SHADOW;
+      var scale = name === "drawImage" ? scaleOf(arguments) : null;
+      var always = name === "getImageData" || shadow || scale;
+      if (!always && (m.calls - m.exactCalls) % SAMPLE_EVERY !== 1) {
+        return original.apply(this, arguments);
+      }
+
+      var start = now();
+      try {
+        return original.apply(this, arguments);
+      } finally {
+        var ms = now() - start;
+        if (always) {
+          m.exactCalls++;
+          m.exactMs += ms;
+        } else {
+          m.timed++;
+          m.ms += ms;
+        }
+        if (name === "getImageData") {
+          var pixels = Math.abs(arguments[2] * arguments[3]) || 0;
+          state.getImageData[0]++;
+          state.getImageData[1] += ms;
+          state.getImageData[2] += pixels;
+          expensive(state, "getImageData", pixels + " px", ms);
+        }
+        if (shadow) {
+          state.shadow[0]++;
+          state.shadow[1] += ms;
+          var blur = "blur " + this.shadowBlur;
+          expensive(state, name + " with shadowBlur", blur, ms);
+        }
+        if (scale) {
+          state.scaled[0]++;
+          state.scaled[1] += ms;
+          if (scale > state.scaled[2]) state.scaled[2] = Math.round(scale);
+          expensive(state, "scaled drawImage", Math.round(scale) + "x", ms);
+        }
+      }
+    };
+  }
+
+  Object.getOwnPropertyNames(proto).forEach(function (name) {
+    var descriptor = Object.getOwnPropertyDescriptor(proto, name);
+    if (name === "constructor" || typeof descriptor.value !== "function") {
+      return;
+    }
+    descriptor.value = wrap(name, descriptor.value);
+    Object.defineProperty(proto, name, descriptor);
+  });
+})();
+//# sourceURL=tauri-spy://probe/canvas.js
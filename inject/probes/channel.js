@@ -0,0 +1,195 @@
+/*
+ * tauri-spy page channel — window.__tauriSpy
+ *
+ * Injected at document start ahead of every other probe. Probes call
+ * __tauriSpy.emit(kind, fields) to queue a record; the queue is posted to
+ * libspy's "tauriSpy" script message handler as one newline-separated
+ * message, at most once per animation frame (once per second while the page
+ * is hidden and rAF is throttled). A frame-scheduled flush would never run
+ * once the page is hidden, so hiding the page flushes the queue at once;
+ * a queue of MAX_QUEUE records is also posted without waiting.
+ *
+ * __tauriSpy.stack(limit) returns the caller's JS stack as "fn@url:line:col"
+ * frames, minus the probes' own frames, for probes that attribute costs to
+ * call sites. __tauriSpy.callSite(callback, limit) does the same for a
+ * callback handed to a wrapped API, once per callback: { site, stack } of
+ * the app code that registered it, or null when probes registered it.
+ * __tauriSpy.round(ms) rounds a duration to the microsecond records carry.
+ *
+ * __tauriSpy.scanElements(scan, attributes) runs scan(elements, limit) for
+ * probes that audit the whole DOM: after load, then SCAN_DELAY_MS after the
+ * DOM (including the named attributes) or the viewport changes. A scan
+ * already pending is left alone, so a page that never settles still gets
+ * one every SCAN_DELAY_MS. scan looks at the first limit of elements, at
+ * most MAX_SCAN_ELEMENTS. It returns a function that asks for a scan.
+ *
+ * __tauriSpy.setTimeout/setInterval/clearTimeout/clearInterval/raf are the
+ * page's originals. Probes schedule their own work through them, so probes
+ * that wrap these globals (timers, raf, hidden-windows) never see it and
+ * never charge it to the app code that happened to start it.
+ */
+(function () {
+  "use strict";
+
+  if (window.__tauriSpy) return;
+
+  var handlers = window.webkit && window.webkit.messageHandlers;
+  var handler = handlers && handlers.tauriSpy;
+  if (!handler) return;
+
+  /* Keep the originals: probes may wrap these globals later on */
+  var now = performance.now.bind(performance);
+  var raf = window.requestAnimationFrame.bind(window);
+  var setTimer = window.setTimeout.bind(window);
+  var clearTimer = window.clearTimeout.bind(window);
+  var setRepeat = window.setInterval.bind(window);
+  var clearRepeat = window.clearInterval.bind(window);
+  var stringify = JSON.stringify;
+
+  var MAX_QUEUE = 1000;
+  var SCAN_DELAY_MS = 2000;
+  var MAX_SCAN_ELEMENTS = 20000;
+
+  var queue = [];
+  var siteOf = new WeakMap();
+  var scheduled = false;
+  var claimed = Object.create(null);
+
+  function flush() {
+    scheduled = false;
+    if (!queue.length) return;
+
+    var batch = queue.join("\n");
+    queue = [];
+    try {
+      handler.postMessage(batch);
+    } catch (e) {
+      /* Handler went away (navigation in progress) — drop the batch */
+    }
+  }
+
+  function schedule() {
+    if (scheduled) return;
+    scheduled = true;
+    if (document.visibilityState === "hidden") {
+      setTimer(flush, 1000);
+    } else {
+      raf(flush);
+    }
+  }
+
+  function round(ms) {
+    return ms === null ? null : Math.round(ms * 1000) / 1000;
+  }
+
+  function emit(kind, fields) {
+    var record = { kind: kind, pt: round(now()) };
+    for (var key in fields) {
+      if (Object.prototype.hasOwnProperty.call(fields, key)) {
+        record[key] = fields[key];
+      }
+    }
+
+    var line;
+    try {
+      line = stringify(record);
+    } catch (e) {
+      return;
+    }
+    queue.push(line);
+    if (queue.length >= MAX_QUEUE) flush();
+    else schedule();
+  }
+
+  var PROBE_URL = "tauri-spy://";
+
+  function stack(limit) {
+    var frames = [];
+    var lines = String(new Error().stack || "").split("\n");
+    for (var i = 0; i < lines.length && frames.length < limit; i++) {
+      var frame = lines[i].trim();
+      if (!frame || frame.indexOf(PROBE_URL) !== -1) continue;
+      if (frame.indexOf(":") === -1) continue; /* No location, or a header */
+      if (frame.indexOf("[native code]") !== -1) continue;
+      frames.push(frame);
+    }
+    return frames;
+  }
+
+  function callSite(callback, limit) {
+    var site = siteOf.get(callback);
+    if (site !== undefined) return site;
+
+    var frames = stack(limit);
+    site = frames.length ? { site: frames[0], stack: frames } : null;
+    siteOf.set(callback, site);
+    return site;
+  }
+
+  function scanElements(scan, attributes) {
+    var pending = null;
+
+    function run() {
+      pending = null;
+      var elements = document.querySelectorAll("*");
+      scan(elements, Math.min(elements.length, MAX_SCAN_ELEMENTS));
+    }
+
+    function schedule() {
+      if (!pending) pending = setTimer(run, SCAN_DELAY_MS);
+    }
+
+    function start() {
+      schedule();
+      new MutationObserver(schedule).observe(document.documentElement, {
+        childList: true,
+        subtree: true,
+        attributes: true,
+        attributeFilter: attributes,
+      });
+      window.addEventListener("resize", schedule);
+    }
+
+    if (document.readyState === "complete") start();
+    else window.addEventListener("load", start);
+    return schedule;
+  }
+
+  /* Each probe claims its name once per document so re-injection is a no-op */
+  function claim(name) {
+    if (claimed[name]) return false;
+    claimed[name] = true;
+    return true;
+  }
+
+  window.addEventListener("pagehide", flush, true);
+  document.addEventListener(
+    "visibilitychange",
+    function () {
+      if (document.visibilityState === "hidden" && scheduled) flush();
+    },
+    true
+  );
+
+  Object.defineProperty(window, "__tauriSpy", {
+    value: Object.freeze({
+      emit: emit,
+      flush: flush,
+      claim: claim,
+      now: now,
+      stack: stack,
+      callSite: callSite,
+      round: round,
+      scanElements: scanElements,
+      setTimeout: setTimer,
+      clearTimeout: clearTimer,
+      setInterval: setRepeat,
+      clearInterval: clearRepeat,
+      raf: raf,
+    }),
+    enumerable: false,
+    configurable: false,
+    writable: false,
+  });
+})();
+//# sourceURL=tauri-spy://probe/channel.js
@@ -0,0 +1,248 @@
+/*
+ * tauri-spy probe: components
+ *
+ * Release builds can't load the React or Vue DevTools extensions, but the
+ * frameworks still look for the extensions' global hooks when they start.
+ * Install minimal stand-ins at document start and count which components
+ * render on every commit, keyed by their path from the root so the report
+ * can fold them into a flamegraph.
+ *
+ *   - React: __REACT_DEVTOOLS_GLOBAL_HOOK__.onCommitFiberRoot() walks the
+ *     fibers that did work. Per-component self time is only tracked by
+ *     React's profiling builds (react-dom/profiling); production builds
+ *     give render counts.
+ *   - Vue 3: __VUE_DEVTOOLS_GLOBAL_HOOK__ receives component:added and
+ *     component:updated, but only from bundles built with
+ *     __VUE_PROD_DEVTOOLS__ enabled. Counts only.
+ *   - Svelte has no devtools hook in production builds.
+ *
+ * Names are whatever the bundle kept; minified names stay minified.
+ */
+(function () {
+  "use strict";
+
+  var spy = window.__tauriSpy;
+  if (!spy || !spy.claim("components")) return;
+
+  /* Component paths reported per second, busiest first */
+  var MAX_STACKS = 500;
+  var MAX_DEPTH = 64;
+
+  var frameworks = Object.create(null);
+  var timer = null;
+
+  function state(framework) {
+    var s = frameworks[framework];
+    if (!s) {
+      s = frameworks[framework] = {
+        commits: 0, /* React only; Vue has no commit event */
+        timed: false,
+        stacks: Object.create(null),
+      };
+    }
+    if (!timer) timer = spy.setInterval(flush, 1000);
+    return s;
+  }
+
+  function rendered(s, path, ms) {
+    var entry = s.stacks[path];
+    if (!entry) entry = s.stacks[path] = [path, 0, 0];
+    entry[1]++;
+    entry[2] += ms;
+  }
+
+  function flush() {
+    var active = false;
+    for (var framework in frameworks) {
+      var s = frameworks[framework];
+      var stacks = [];
+      for (var path in s.stacks) {
+        var e = s.stacks[path];
+        stacks.push([e[0], e[1], spy.round(e[2])]);
+      }
+      if (!stacks.length && !s.commits) continue;
+      active = true;
+
+      stacks.sort(function (a, b) {
+        return b[1] - a[1];
+      });
+      spy.emit("component_renders", {
+        framework: framework,
+        commits: s.commits,
+        timed: s.timed,
+        stacks: stacks.slice(0, MAX_STACKS),
+      });
+      s.commits = 0;
+      s.stacks = Object.create(null);
+    }
+    if (!active) {
+      spy.clearInterval(timer);
+      timer = null;
+    }
+  }
+
+  /* React ----------------------------------------------------------------- */
+
+  /* Fiber tags for Function, Class, ForwardRef, Memo and SimpleMemo */
+  var COMPONENT_TAGS = { 0: 1, 1: 1, 11: 1, 14: 1, 15: 1 };
+  var PERFORMED_WORK = 1;
+
+  function reactName(fiber) {
+    var type = fiber.type;
+    if (!type) return "Anonymous";
+    if (typeof type === "function") {
+      return type.displayName || type.name || "Anonymous";
+    }
+    if (type.displayName) return type.displayName;
+    var inner = type.render || type.type; /* forwardRef() / memo() */
+    if (inner) return inner.displayName || inner.name || "Anonymous";
+    return "Anonymous";
+  }
+
+  function didRender(fiber) {
+    if (!fiber.alternate) return true; /* Mounted in this commit */
+    var flags = fiber.flags !== undefined ? fiber.flags : fiber.effectTag;
+    return (flags & PERFORMED_WORK) === PERFORMED_WORK;
+  }
+
+  function selfDuration(fiber) {
+    if (typeof fiber.actualDuration !== "number") return 0;
+    var ms = fiber.actualDuration;
+    for (var child = fiber.child; child; child = child.sibling) {
+      ms -= child.actualDuration || 0;
+    }
+    return ms > 0 ? ms : 0;
+  }
+
+  function onReactCommit(root) {
+    var s = state("react");
+    s.commits++;
+    if (!root || !root.current) return;
+    if (typeof root.current.actualDuration === "number") s.timed = true;
+
+    /* Iterative walk: [fiber, path of its parent, component depth] */
+    var work = [[root.current.child, "", 0]];
+    while (work.length) {
+      var item = work.pop();
+      var fiber = item[0];
+      if (!fiber) continue;
+      var path = item[1];
+      var depth = item[2];
+
+      if (fiber.sibling) work.push([fiber.sibling, path, depth]);
+
+      var childPath = path;
+      var childDepth = depth;
+      if (COMPONENT_TAGS[fiber.tag] && depth < MAX_DEPTH) {
+        childPath = path ? path + ";" + reactName(fiber) : reactName(fiber);
+        childDepth = depth + 1;
+        if (didRender(fiber)) rendered(s, childPath, selfDuration(fiber));
+      }
+
+      /* A bailed-out subtree keeps the very same child fibers */
+      var alternate = fiber.alternate;
+      if (alternate && fiber.child === alternate.child) continue;
+      if (fiber.child) work.push([fiber.child, childPath, childDepth]);
+    }
+  }
+
+  function installReact() {
+    if (window.__REACT_DEVTOOLS_GLOBAL_HOOK__) return false;
+
+    var renderers = new Map();
+    var noop = function () {};
+    window.__REACT_DEVTOOLS_GLOBAL_HOOK__ = {
+      renderers: renderers,
+      supportsFiber: true,
+      inject: function (renderer) {
+        var id = renderers.size + 1;
+        renderers.set(id, renderer);
+        return id;
+      },
+      onCommitFiberRoot: function (id, root) {
+        try {
+          onReactCommit(root);
+        } catch (e) {
+          /* Never break the app's commit */
+        }
+      },
+      onCommitFiberUnmount: noop,
+      onPostCommitFiberRoot: noop,
+      onScheduleFiberRoot: noop,
+      checkDCE: noop,
+    };
+    return true;
+  }
+
+  /* Vue 3 ----------------------------------------------------------------- */
+
+  function vueName(instance) {
+    var type = instance && instance.type;
+    if (!type) return "Anonymous";
+    return type.name || type.__name || "Anonymous";
+  }
+
+  function vuePath(instance) {
+    var names = [];
+    for (var i = instance; i && names.length < MAX_DEPTH; i = i.parent) {
+      names.push(vueName(i));
+    }
+    return names.reverse().join(";");
+  }
+
+  function installVue() {
+    if (window.__VUE_DEVTOOLS_GLOBAL_HOOK__) return false;
+
+    var listeners = Object.create(null);
+    var hook = {
+      enabled: true,
+      emit: function (event, app, uid, parentUid, instance) {
+        if (event === "app:init") {
+          state("vue");
+        } else if (
+          (event === "component:added" || event === "component:updated") &&
+          instance
+        ) {
+          rendered(state("vue"), vuePath(instance), 0);
+        }
+        var handlers = listeners[event];
+        if (handlers) {
+          var args = Array.prototype.slice.call(arguments, 1);
+          handlers.slice().forEach(function (handler) {
+            handler.apply(null, args);
+          });
+        }
+      },
+      on: function (event, handler) {
+        (listeners[event] = listeners[event] || []).push(handler);
+      },
+      once: function (event, handler) {
+        var wrapper = function () {
+          hook.off(event, wrapper);
+          handler.apply(null, arguments);
+        };
+        hook.on(event, wrapper);
+      },
+      off: function (event, handler) {
+        var handlers = listeners[event];
+        if (handlers) {
+          var index = handlers.indexOf(handler);
+          if (index !== -1) handlers.splice(index, 1);
+        }
+      },
+    };
+    window.__VUE_DEVTOOLS_GLOBAL_HOOK__ = hook;
+    return true;
+  }
+
+  var installed = [];
+  if (installReact()) installed.push("react");
+  if (installVue()) installed.push("vue");
+  if (installed.length < 2) {
+    spy.emit("component_hooks", {
+      installed: installed,
+      reason: "another devtools hook was already defined",
+    });
+  }
+})();
+//# sourceURL=tauri-spy://probe/components.js
@@ -0,0 +1,214 @@
+/*
+ * tauri-spy probe: console
+ *
+ * Wrap the console logging methods. Every call is passed on unchanged and
+ * timed: with the inspector enabled WebKit keeps each message and its
+ * arguments for the console, so heavy logging costs even while nobody
+ * looks. The formatted text also goes to libspy's "tauriSpyConsole" handler,
+ * which appends it to a rotating file per webview next to the report; at
+ * most MAX_LINES lines a second are written and the rest only counted.
+ *
+ * Strings count in full towards the characters logged, though a line in the
+ * file stops at MAX_CHARS; objects are described by a bounded preview and
+ * count as its length.
+ *
+ * Once per second a "console" record gives the calls, characters of
+ * formatted text and time spent, and per call site and level the same
+ * counts. The first record naming a site also carries its stack.
+ */
+(function () {
+  "use strict";
+
+  var spy = window.__tauriSpy;
+  if (!spy || !window.console || !spy.claim("console")) return;
+
+  var LEVELS = ["log", "info", "warn", "error", "debug", "trace"];
+  var MAX_LINES = 1000;
+  var MAX_CHARS = 4096;
+  var PREVIEW_KEYS = 8;
+  var STACK_DEPTH = 6;
+
+  var handlers = window.webkit && window.webkit.messageHandlers;
+  var handler = handlers && handlers.tauriSpyConsole;
+  var now = spy.now;
+  var stringify = JSON.stringify;
+
+  var sites = Object.create(null);
+  var reported = Object.create(null);
+  var lines = [];
+  var second = { calls: 0, chars: 0, ms: 0, dropped: 0 };
+  var inside = false;
+  var timer = null;
+
+  var round = spy.round;
+
+  function flush() {
+    if (lines.length && handler) {
+      try {
+        handler.postMessage(lines.join("\n"));
+      } catch (e) {
+        /* Handler went away (navigation in progress) — drop the lines */
+      }
+    }
+    lines = [];
+
+    var s = second;
+    second = { calls: 0, chars: 0, ms: 0, dropped: 0 };
+    if (!s.calls) {
+      spy.clearInterval(timer);
+      timer = null;
+      return;
+    }
+
+    var rows = [];
+    var stacks = {};
+    for (var key in sites) {
+      var site = sites[key];
+      rows.push([
+        site.site,
+        site.level,
+        site.calls,
+        site.chars,
+        round(site.ms),
+      ]);
+      if (!reported[site.site]) {
+        reported[site.site] = true;
+        stacks[site.site] = site.stack;
+      }
+    }
+    sites = Object.create(null);
+    spy.emit("console", {
+      calls: s.calls,
+      chars: s.chars,
+      ms: round(s.ms),
+      dropped: s.dropped,
+      sites: rows,
+      stacks: stacks,
+    });
+  }
+
+  function typeName(value) {
+    try {
+      var proto = Object.getPrototypeOf(value);
+      var ctor = proto && Object.getOwnPropertyDescriptor(proto, "constructor");
+      var name = ctor && typeof ctor.value === "function" && ctor.value.name;
+      return name || (proto ? "Object" : "null-prototype");
+    } catch (e) {
+      return "Object";
+    }
+  }
+
+  /*
+   * A bounded one-line preview: the constructor name and the first few own
+   * data properties, one level deep. Getters and toJSON are never called,
+   * so logging an object costs the same however large it is and has no
+   * side effects beyond the app's own console call.
+   */
+  function preview(value) {
+    var name = typeName(value);
+    if (Array.isArray(value)) return name + "(" + value.length + ")";
+    var keys;
+    try {
+      keys = Object.keys(value);
+    } catch (e) {
+      return name;
+    }
+    var fields = [];
+    for (var i = 0; i < keys.length && i < PREVIEW_KEYS; i++) {
+      var d = Object.getOwnPropertyDescriptor(value, keys[i]);
+      var v = d && d.value;
+      var shown;
+      if (!d || d.get || d.set) shown = "(getter)";
+      else if (typeof v === "string") shown = stringify(v.slice(0, 40));
+      else if (v !== null && typeof v === "object") shown = typeName(v);
+      else if (typeof v === "function") shown = "ƒ";
+      else shown = String(v);
+      fields.push(keys[i] + ": " + shown);
+    }
+    if (keys.length > PREVIEW_KEYS) fields.push("…");
+    return name + " {" + fields.join(", ") + "}";
+  }
+
+  function describe(value) {
+    if (typeof value === "string") return value;
+    if (value instanceof Error) return String(value.stack || value);
+    if (value === null || typeof value !== "object") return String(value);
+    return preview(value);
+  }
+
+  /* The full length counts towards chars; only the text is truncated */
+  function format(args) {
+    var parts = [];
+    var chars = 0;
+    for (var i = 0; i < args.length; i++) {
+      var part = describe(args[i]);
+      chars += part.length + (i ? 1 : 0);
+      if (chars - part.length <= MAX_CHARS) {
+        parts.push(part.length > MAX_CHARS ? part.slice(0, MAX_CHARS) : part);
+      }
+    }
+    var text = parts.join(" ");
+    if (text.length > MAX_CHARS) text = text.slice(0, MAX_CHARS);
+    if (chars > text.length) text += "…";
+    return { text: text, chars: chars };
+  }
+
+  function record(level, args, ms) {
+    var stack = spy.stack(STACK_DEPTH);
+    var site = stack[0] || "(unknown)";
+    var formatted = format(args);
+    var text = formatted.text;
+
+    var key = level + "\n" + site;
+    var entry = sites[key];
+    if (!entry) {
+      entry = sites[key] = {
+        site: site,
+        level: level,
+        stack: stack,
+        calls: 0,
+        chars: 0,
+        ms: 0,
+      };
+    }
+    entry.calls++;
+    entry.chars += formatted.chars;
+    entry.ms += ms;
+    second.calls++;
+    second.chars += formatted.chars;
+    second.ms += ms;
+
+    if (lines.length < MAX_LINES) {
+      var pt = round(now()).toFixed(3);
+      lines.push(
+        pt + " " + level + " " + site + "\n    " + text.replace(/\n/g, "\n    ")
+      );
+    } else {
+      second.dropped++;
+    }
+    if (!timer) timer = spy.setInterval(flush, 1000);
+  }
+
+  LEVELS.forEach(function (level) {
+    var original = console[level];
+    if (typeof original !== "function") return;
+    console[level] = function () {
+      if (inside) return original.apply(this, arguments);
+      var start = now();
+      try {
+        return original.apply(this, arguments);
+      } finally {
+        var ms = now() - start;
+        inside = true;
+        try {
+          record(level, arguments, ms);
+        } finally {
+          inside = false;
+        }
+      }
+    };
+  });
+
+  window.addEventListener("pagehide", flush, true);
+})();
+//# sourceURL=tauri-spy://probe/console.js
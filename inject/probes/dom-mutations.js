@@ -0,0 +1,174 @@
+/*
+ * tauri-spy probe: dom-mutations
+ *
+ * One MutationObserver over the whole document. Once per second, report how
+ * many mutation records arrived by type, how many nodes they added and
+ * removed (counting the elements inside inserted subtrees) and which subtree
+ * roots took the most churn. A root is the nearest ancestor with an id, or
+ * else the element directly under <body>. Roots are looked up once per
+ * observer callback, since ids, classes and the tree itself change between
+ * callbacks, and labelled when reported.
+ *
+ * Each observer callback holds everything one task changed, so a callback
+ * touching STORM_NODES nodes or more is reported on its own as a storm: a
+ * framework re-rendering far more than the state change needed.
+ */
+(function () {
+  "use strict";
+
+  var spy = window.__tauriSpy;
+  if (!spy || !spy.claim("dom-mutations")) return;
+
+  var STORM_NODES = 1000;
+  var TOP_ROOTS = 5;
+
+  var timer = null;
+  var second = null;
+
+  function emptySecond() {
+    return {
+      records: 0,
+      callbacks: 0,
+      added: 0,
+      removed: 0,
+      attributes: 0,
+      text: 0,
+      storms: 0,
+      roots: new Map(), /* root element (or null) -> nodes */
+    };
+  }
+
+  function describe(element) {
+    if (!element) return "document";
+    if (element.id) return "#" + element.id;
+    var name = element.localName || element.nodeName.toLowerCase();
+    var className = element.getAttribute && element.getAttribute("class");
+    if (className) {
+      name += "." + className.trim().split(/\s+/).slice(0, 2).join(".");
+    }
+    return name;
+  }
+
+  /* cache maps elements to their root for the current callback only */
+  function findRoot(node, cache) {
+    var element = node.nodeType === 1 ? node : node.parentElement;
+    if (!element) return null;
+
+    var cached = cache.get(element);
+    if (cached) return cached;
+
+    var root = null;
+    for (var e = element; e; e = e.parentElement) {
+      if (e.id) {
+        root = e;
+        break;
+      }
+      if (e.parentElement === document.body) {
+        root = e;
+        break;
+      }
+    }
+    root = root || element;
+    cache.set(element, root);
+    return root;
+  }
+
+  function count(roots, root, nodes) {
+    roots.set(root, (roots.get(root) || 0) + nodes);
+  }
+
+  function subtreeSize(nodes) {
+    var n = 0;
+    for (var i = 0; i < nodes.length; i++) {
+      var node = nodes[i];
+      n++;
+      if (node.nodeType === 1) n += node.getElementsByTagName("*").length;
+    }
+    return n;
+  }
+
+  function topRoots(roots) {
+    var list = [];
+    roots.forEach(function (nodes, root) {
+      list.push([root, nodes]);
+    });
+    list.sort(function (a, b) {
+      return b[1] - a[1];
+    });
+    return list.slice(0, TOP_ROOTS).map(function (entry) {
+      return [describe(entry[0]), entry[1]];
+    });
+  }
+
+  function flush() {
+    var s = second;
+    second = null;
+    if (!s) {
+      spy.clearInterval(timer);
+      timer = null;
+      return;
+    }
+
+    spy.emit("dom_mutations", {
+      records: s.records,
+      callbacks: s.callbacks,
+      added: s.added,
+      removed: s.removed,
+      attributes: s.attributes,
+      text: s.text,
+      storms: s.storms,
+      roots: topRoots(s.roots),
+    });
+  }
+
+  function observe(mutations) {
+    if (!second) second = emptySecond();
+    var s = second;
+    var touched = 0;
+    var roots = new Map();
+    var cache = new Map();
+
+    for (var i = 0; i < mutations.length; i++) {
+      var m = mutations[i];
+      var nodes = 1;
+
+      if (m.type === "childList") {
+        var added = subtreeSize(m.addedNodes);
+        var removed = m.removedNodes.length;
+        s.added += added;
+        s.removed += removed;
+        nodes = added + removed;
+      } else if (m.type === "attributes") {
+        s.attributes++;
+      } else {
+        s.text++;
+      }
+
+      var root = findRoot(m.target, cache);
+      count(roots, root, nodes);
+      count(s.roots, root, nodes);
+      touched += nodes;
+    }
+    s.records += mutations.length;
+    s.callbacks++;
+
+    if (touched >= STORM_NODES) {
+      s.storms++;
+      spy.emit("dom_storm", {
+        records: mutations.length,
+        nodes: touched,
+        roots: topRoots(roots),
+      });
+    }
+
+    if (!timer) timer = spy.setInterval(flush, 1000);
+  }
+
+  new MutationObserver(observe).observe(document, {
+    childList: true,
+    attributes: true,
+    characterData: true,
+    subtree: true,
+  });
+})();
+//# sourceURL=tauri-spy://probe/dom-mutations.js
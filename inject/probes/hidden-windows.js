@@ -0,0 +1,44 @@
+/*
+ * tauri-spy probe: hidden-windows
+ *
+ * Page side of libspy's hidden-window detector (windows.c): count
+ * requestAnimationFrame callbacks once per second, with the page's own idea
+ * of its visibility. WebKit doesn't always hide the page when its window is
+ * minimized or covered, so rAF loops can keep running there; the report
+ * matches these counts against the native window state.
+ */
+(function () {
+  "use strict";
+
+  var spy = window.__tauriSpy;
+  if (!spy || !spy.claim("hidden-windows")) return;
+
+  var originalRaf = window.requestAnimationFrame;
+  var callbacks = 0;
+  var timer = null;
+
+  function flush() {
+    if (!callbacks) {
+      spy.clearInterval(timer);
+      timer = null;
+      return;
+    }
+    spy.emit("raf_activity", {
+      callbacks: callbacks,
+      visibility: document.visibilityState,
+    });
+    callbacks = 0;
+  }
+
+  window.requestAnimationFrame = function (callback) {
+    if (typeof callback !== "function") {
+      return originalRaf.call(window, callback);
+    }
+    return originalRaf.call(window, function () {
+      callbacks++;
+      if (!timer) timer = spy.setInterval(flush, 1000);
+      return callback.apply(this, arguments);
+    });
+  };
+})();
+//# sourceURL=tauri-spy://probe/hidden-windows.js
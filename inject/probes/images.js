@@ -0,0 +1,291 @@
+/*
+ * tauri-spy probe: images
+ *
+ * Enumerate <img> elements and CSS background images, and for each distinct
+ * URL compare its natural size with the largest size it is rendered at, in
+ * device pixels. A decoded bitmap costs width * height * 4 bytes of renderer
+ * memory however small it is drawn, so a 4000px PNG shown as a 64px icon
+ * holds ~61 MB for nothing.
+ *
+ * Natural sizes come from the <img> element itself, or from loading a CSS
+ * background's URL once (from cache, without decoding it). Rendered sizes
+ * come from a ResizeObserver, which reports layout boxes as the page lays
+ * itself out, so a scan never forces layout; an element seen for the first
+ * time is counted once its box arrives. Computed styles are still read for
+ * background-image, which costs a style recalc at most.
+ *
+ * Only the TOP_IMAGES largest bitmaps, the ones reported, are decoded once
+ * more off-screen through HTMLImageElement decode(), timing what the
+ * renderer pays to decode them; <img> elements without decoding="async" and
+ * all background images pay that on the main thread. The file size comes
+ * from resource timing where the scheme reports it.
+ *
+ * The page is scanned through __tauriSpy.scanElements(), and also when an
+ * element's box changes; an "images" record is emitted whenever the result
+ * changed, with the TOP_IMAGES largest bitmaps.
+ */
+(function () {
+  "use strict";
+
+  var spy = window.__tauriSpy;
+  if (!spy || !spy.claim("images")) return;
+
+  var TOP_IMAGES = 20;
+  var URL_LENGTH = 200;
+
+  var now = spy.now;
+  var measuring = Object.create(null); /* url -> Promise */
+  var decodes = Object.create(null); /* url -> ms */
+  var loading = Object.create(null); /* url -> Promise */
+  var naturals = Object.create(null); /* url -> {width, height} | null */
+  var boxes = new WeakMap(); /* element -> [width, height] device px */
+  var observed = new Set();
+  var sizer = window.ResizeObserver
+    ? new ResizeObserver(function (entries) {
+        var ratio = window.devicePixelRatio || 1;
+        entries.forEach(function (entry) {
+          boxes.set(entry.target, [
+            Math.round(entry.contentRect.width * ratio),
+            Math.round(entry.contentRect.height * ratio),
+          ]);
+        });
+        schedule();
+      })
+    : null;
+  var schedule = null;
+  var lastSignature = "";
+
+  function isVector(url) {
+    return /^data:image\/svg/i.test(url) || /\.svg(?:[?#]|$)/i.test(url);
+  }
+
+  function label(url) {
+    if (url.length <= URL_LENGTH) return url;
+    return url.slice(0, URL_LENGTH) + "… (" + url.length + " chars)";
+  }
+
+  function fileBytes(url) {
+    if (/^data:/i.test(url)) return Math.round((url.length * 3) / 4);
+    var entries = performance.getEntriesByName(url, "resource");
+    var entry = entries[entries.length - 1];
+    if (!entry) return null;
+    return entry.encodedBodySize || entry.transferSize || null;
+  }
+
+  /* Resolves once the URL has been decoded off-screen, or failed to */
+  function measure(url) {
+    if (measuring[url]) return measuring[url];
+
+    var image = new Image();
+    var start;
+    image.src = url;
+    return (measuring[url] = new Promise(function (resolve) {
+      image.onload = function () {
+        start = now();
+        image.decode().then(function () {
+          decodes[url] = now() - start;
+          resolve();
+        }, resolve);
+      };
+      image.onerror = resolve;
+    }));
+  }
+
+  /* Resolves once a background's natural size is known, or can't be */
+  function loadNatural(url) {
+    if (loading[url]) return loading[url];
+
+    var image = new Image();
+    image.src = url;
+    return (loading[url] = new Promise(function (resolve) {
+      image.onload = function () {
+        naturals[url] = {
+          width: image.naturalWidth,
+          height: image.naturalHeight,
+        };
+        resolve();
+      };
+      image.onerror = function () {
+        naturals[url] = null;
+        resolve();
+      };
+    }));
+  }
+
+  /* The element's last laid-out size; [0, 0] until the observer reports */
+  function boxOf(element, seen) {
+    seen.add(element);
+    if (!sizer) {
+      var rect = element.getBoundingClientRect();
+      var ratio = window.devicePixelRatio || 1;
+      return [Math.round(rect.width * ratio), Math.round(rect.height * ratio)];
+    }
+    if (!observed.has(element)) {
+      observed.add(element);
+      sizer.observe(element);
+    }
+    return boxes.get(element) || [0, 0];
+  }
+
+  function use(found, url, kind, element, sync, natural) {
+    if (!url || isVector(url)) return;
+    var box = boxOf(element, found.seen);
+
+    var entry = found.urls[url];
+    if (!entry) {
+      entry = found.urls[url] = {
+        kind: kind,
+        width: 0,
+        height: 0,
+        elements: 0,
+        sync: false,
+        natural: natural,
+      };
+    }
+    entry.elements++;
+    if (sync) entry.sync = true;
+    if (box[0] * box[1] > entry.width * entry.height) {
+      entry.width = box[0];
+      entry.height = box[1];
+    }
+  }
+
+  function backgroundUrls(element) {
+    var value = getComputedStyle(element).backgroundImage;
+    if (!value || value === "none") return [];
+    var urls = [];
+    var pattern = /url\(\s*(['"]?)(.*?)\1\s*\)/g;
+    var match;
+    while ((match = pattern.exec(value))) urls.push(match[2]);
+    return urls;
+  }
+
+  function resolve(url) {
+    try {
+      return new URL(url, document.baseURI).href;
+    } catch (e) {
+      return null; /* Malformed url() in a style */
+    }
+  }
+
+  function collect(elements, limit) {
+    var found = { urls: Object.create(null), seen: new Set() };
+    var images = document.images;
+    for (var i = 0; i < images.length; i++) {
+      var image = images[i];
+      use(
+        found,
+        image.currentSrc || image.src,
+        "img",
+        image,
+        image.decoding !== "async",
+        image.complete
+          ? { width: image.naturalWidth, height: image.naturalHeight }
+          : null
+      );
+    }
+
+    for (var j = 0; j < limit; j++) {
+      var urls = backgroundUrls(elements[j]);
+      for (var k = 0; k < urls.length; k++) {
+        var url = resolve(urls[k]);
+        if (url) use(found, url, "background", elements[j], true, null);
+      }
+    }
+
+    /* Elements gone from the page no longer need their box */
+    observed.forEach(function (element) {
+      if (found.seen.has(element)) return;
+      observed.delete(element);
+      sizer.unobserve(element);
+    });
+    return { found: found.urls, elements: elements.length };
+  }
+
+  function naturalOf(url, seen) {
+    return seen.natural || naturals[url] || null;
+  }
+
+  /* Every image with a known natural size, largest bitmap first */
+  function bitmapsOf(scan) {
+    var bitmaps = [];
+    for (var url in scan.found) {
+      var seen = scan.found[url];
+      var natural = naturalOf(url, seen);
+      if (!natural || !natural.width) continue;
+      bitmaps.push({
+        url: url,
+        seen: seen,
+        natural: natural,
+        bytes: natural.width * natural.height * 4,
+      });
+    }
+    bitmaps.sort(function (a, b) {
+      return b.bytes - a.bytes;
+    });
+    return bitmaps;
+  }
+
+  function report(scan, bitmaps) {
+    var rows = [];
+    var decodedBytes = 0;
+    var wastedBytes = 0;
+    bitmaps.forEach(function (bitmap) {
+      var seen = bitmap.seen;
+      var shown = seen.width * seen.height * 4;
+      var ms = decodes[bitmap.url];
+      decodedBytes += bitmap.bytes;
+      if (shown && bitmap.bytes > shown) wastedBytes += bitmap.bytes - shown;
+      rows.push([
+        label(bitmap.url),
+        seen.kind,
+        bitmap.natural.width,
+        bitmap.natural.height,
+        seen.width,
+        seen.height,
+        seen.elements,
+        bitmap.bytes,
+        fileBytes(bitmap.url),
+        ms === undefined ? null : spy.round(ms),
+        seen.sync,
+      ]);
+    });
+
+    var signature = rows
+      .map(function (row) {
+        return row.slice(0, 7).join(" ");
+      })
+      .join("\n");
+    if (signature === lastSignature) return;
+    lastSignature = signature;
+
+    spy.emit("images", {
+      elements: scan.elements,
+      images: rows.length,
+      decoded_bytes: decodedBytes,
+      wasted_bytes: wastedBytes,
+      items: rows.slice(0, TOP_IMAGES),
+    });
+  }
+
+  function scan(elements, limit) {
+    var result = collect(elements, limit);
+    var pending = [];
+    for (var url in result.found) {
+      if (!naturalOf(url, result.found[url])) pending.push(loadNatural(url));
+    }
+    Promise.all(pending).then(function () {
+      var bitmaps = bitmapsOf(result);
+      /* Only the reported bitmaps are worth a second decode */
+      var decoding = bitmaps.slice(0, TOP_IMAGES).map(function (bitmap) {
+        return measure(bitmap.url);
+      });
+      Promise.all(decoding).then(function () {
+        report(result, bitmaps);
+      });
+    });
+  }
+
+  schedule = spy.scanElements(scan, ["src", "srcset", "style", "class"]);
+})();
+//# sourceURL=tauri-spy://probe/images.js
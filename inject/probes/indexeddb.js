@@ -0,0 +1,246 @@
+/*
+ * tauri-spy probe: indexeddb
+ *
+ * Wrap indexedDB.open(), IDBDatabase.transaction() and the object store and
+ * index request methods. Each request is timed from the call to its first
+ * success or error event; for cursors that is the first result, and every
+ * further step is counted. Transactions are timed from creation to complete
+ * or abort.
+ *
+ * Read-write transactions over the same store run one after another, so a
+ * long one holds up every transaction created behind it. Live read-write
+ * transactions count the transactions that queued on their stores; one
+ * lasting LONG_TRANSACTION_MS or more is reported as "idb_long_transaction"
+ * with its stack. Opens are reported as "idb_open", with the time spent in
+ * an upgrade and whether another tab or window blocked it.
+ *
+ * Once per second an "indexeddb" record gives per database, store and
+ * operation the requests, latency and errors, and per database and mode the
+ * transactions that finished.
+ */
+(function () {
+  "use strict";
+
+  var spy = window.__tauriSpy;
+  if (!spy || !window.IDBFactory || !spy.claim("indexeddb")) return;
+
+  var LONG_TRANSACTION_MS = 100;
+  var STACK_DEPTH = 6;
+
+  var STORE_METHODS = [
+    "get",
+    "getAll",
+    "getAllKeys",
+    "getKey",
+    "put",
+    "add",
+    "delete",
+    "clear",
+    "count",
+    "openCursor",
+    "openKeyCursor",
+  ];
+
+  var now = spy.now;
+  var operations = Object.create(null);
+  var transactions = Object.create(null);
+  var live = []; /* Read-write transactions still running */
+  var timer = null;
+
+  var round = spy.round;
+
+  function touched() {
+    if (!timer) timer = spy.setInterval(flush, 1000);
+  }
+
+  function flush() {
+    var ops = [];
+    for (var id in operations) {
+      var o = operations[id];
+      ops.push([
+        o.db,
+        o.store,
+        o.op,
+        o.count,
+        round(o.ms),
+        round(o.maxMs),
+        o.errors,
+        o.steps,
+      ]);
+    }
+    var txs = [];
+    for (var key in transactions) {
+      var t = transactions[key];
+      txs.push([t.db, t.mode, t.count, round(t.ms), round(t.maxMs), t.aborted]);
+    }
+    operations = Object.create(null);
+    transactions = Object.create(null);
+
+    if (!ops.length && !txs.length) {
+      spy.clearInterval(timer);
+      timer = null;
+      return;
+    }
+    spy.emit("indexeddb", { operations: ops, transactions: txs });
+  }
+
+  function operation(db, store, op) {
+    var id = [db, store, op].join("\n");
+    var o = operations[id];
+    if (!o) {
+      o = operations[id] = {
+        db: db,
+        store: store,
+        op: op,
+        count: 0,
+        ms: 0,
+        maxMs: 0,
+        errors: 0,
+        steps: 0,
+      };
+    }
+    return o;
+  }
+
+  function watchRequest(request, db, store, op) {
+    var start = now();
+    var answered = false;
+    function done(event) {
+      var o = operation(db, store, op);
+      touched();
+      if (answered) {
+        o.steps++;
+        return;
+      }
+      answered = true;
+      var ms = now() - start;
+      o.count++;
+      o.ms += ms;
+      if (ms > o.maxMs) o.maxMs = ms;
+      if (event.type === "error") o.errors++;
+    }
+    request.addEventListener("success", done);
+    request.addEventListener("error", done);
+  }
+
+  function wrapRequests(Interface, prefix) {
+    if (!Interface) return;
+    var proto = Interface.prototype;
+    STORE_METHODS.forEach(function (name) {
+      var original = proto[name];
+      if (typeof original !== "function") return;
+      proto[name] = function () {
+        var request = original.apply(this, arguments);
+        var store = prefix ? this.objectStore : this;
+        var db = store.transaction.db.name;
+        var label = prefix ? store.name + "." + this.name : store.name;
+        watchRequest(request, db, label, prefix + name);
+        return request;
+      };
+    });
+  }
+
+  wrapRequests(window.IDBObjectStore, "");
+  wrapRequests(window.IDBIndex, "index.");
+
+  function overlaps(a, b) {
+    for (var i = 0; i < a.length; i++) {
+      if (b.indexOf(a[i]) >= 0) return true;
+    }
+    return false;
+  }
+
+  var originalTransaction = IDBDatabase.prototype.transaction;
+  IDBDatabase.prototype.transaction = function () {
+    var transaction = originalTransaction.apply(this, arguments);
+    var db = this.name;
+    var stores = Array.prototype.slice.call(transaction.objectStoreNames);
+    var kind = transaction.mode;
+    var start = now();
+
+    for (var i = 0; i < live.length; i++) {
+      if (live[i].db === db && overlaps(live[i].stores, stores)) {
+        live[i].queued++;
+      }
+    }
+    var entry = null;
+    if (kind !== "readonly") {
+      entry = {
+        db: db,
+        stores: stores,
+        queued: 0,
+        stack: spy.stack(STACK_DEPTH),
+      };
+      live.push(entry);
+    }
+
+    function done(event) {
+      var ms = now() - start;
+      var key = db + "\n" + kind;
+      var t = transactions[key];
+      if (!t) {
+        t = transactions[key] = {
+          db: db,
+          mode: kind,
+          count: 0,
+          ms: 0,
+          maxMs: 0,
+          aborted: 0,
+        };
+      }
+      t.count++;
+      t.ms += ms;
+      if (ms > t.maxMs) t.maxMs = ms;
+      if (event.type === "abort") t.aborted++;
+      touched();
+
+      if (!entry) return;
+      live.splice(live.indexOf(entry), 1);
+      if (ms >= LONG_TRANSACTION_MS) {
+        spy.emit("idb_long_transaction", {
+          db: db,
+          stores: stores,
+          mode: kind,
+          ms: round(ms),
+          queued: entry.queued,
+          aborted: event.type === "abort",
+          site: entry.stack[0] || null,
+          stack: entry.stack,
+        });
+      }
+    }
+    transaction.addEventListener("complete", done);
+    transaction.addEventListener("abort", done);
+    return transaction;
+  };
+
+  var originalOpen = IDBFactory.prototype.open;
+  IDBFactory.prototype.open = function (name) {
+    var request = originalOpen.apply(this, arguments);
+    var start = now();
+    var upgradeStart = null;
+    var blocked = false;
+
+    request.addEventListener("blocked", function () {
+      blocked = true;
+    });
+    request.addEventListener("upgradeneeded", function () {
+      upgradeStart = now();
+    });
+    function done(event) {
+      var end = now();
+      spy.emit("idb_open", {
+        db: String(name),
+        version: event.type === "success" ? request.result.version : null,
+        ms: round(end - start),
+        upgrade_ms: upgradeStart === null ? null : round(end - upgradeStart),
+        blocked: blocked,
+        error: event.type === "error" ? String(request.error) : null,
+      });
+    }
+    request.addEventListener("success", done);
+    request.addEventListener("error", done);
+    return request;
+  };
+})();
+//# sourceURL=tauri-spy://probe/indexeddb.js
@@ -0,0 +1,67 @@
+/*
+ * tauri-spy init-script timing (built-in)
+ *
+ * libspy brackets every main-world init script registered by the app with
+ * marker scripts that push [id, phase, bytes, at_document_end, time] into
+ * self.__tauriSpyInit. Once the page has loaded, pair them up and report how
+ * long this navigation spent evaluating init scripts — and how much of that
+ * ran at document start, before any of the app's own code could.
+ */
+(function () {
+  "use strict";
+
+  var spy = window.__tauriSpy;
+  if (!spy || !spy.claim("init-scripts")) return;
+
+  function report() {
+    var marks = self.__tauriSpyInit;
+    if (!marks || !marks.length) return;
+
+    var begun = Object.create(null);
+    var scripts = [];
+    var totals = { bytes: 0, eval_ms: 0, start_bytes: 0, start_ms: 0 };
+    var done = 0;
+
+    for (var i = 0; i < marks.length; i++) {
+      var m = marks[i];
+      if (m[1] === 0) {
+        begun[m[0]] = m;
+        continue;
+      }
+      var begin = begun[m[0]];
+      if (!begin) continue;
+
+      var ms = m[4] - begin[4];
+      scripts.push([m[0], m[2], spy.round(ms)]);
+      totals.bytes += m[2];
+      totals.eval_ms += ms;
+      if (!m[3]) {
+        totals.start_bytes += m[2];
+        totals.start_ms += ms;
+        done = Math.max(done, m[4]);
+      }
+    }
+
+    spy.emit("init_scripts", {
+      url: location.href,
+      scripts: scripts.length,
+      bytes: totals.bytes,
+      eval_ms: spy.round(totals.eval_ms),
+      start_bytes: totals.start_bytes,
+      start_ms: spy.round(totals.start_ms),
+      /* Earliest point the app's own scripts could start running */
+      start_done_ms: spy.round(done),
+      /* [id, bytes, ms] per script, ids match native user_script records */
+      per_script: scripts,
+    });
+  }
+
+  if (document.readyState === "complete") {
+    report();
+  } else {
+    window.addEventListener("load", function () {
+      spy.setTimeout(report, 0);
+    });
+  }
+})();
+//# sourceURL=tauri-spy://probe/init-scripts.js
@@ -0,0 +1,259 @@
+/*
+ * tauri-spy probe: ipc-channels
+ *
+ * Tauri v2 Channels deliver each message through a long-lived callback
+ * registered with __TAURI_INTERNALS__.transformCallback(); the payload is
+ * {index, message} (or {index, end}). Wrap every non-once callback, treat
+ * the ones that receive such payloads as channels, and report once per
+ * second per channel: messages, estimated bytes, time spent in the consumer's
+ * handler and how far delivery runs ahead of the in-order consumer.
+ *
+ * Callbacks with other payload shapes (event listeners, channels of other
+ * IPC layers) can't be told apart from one another and are not reported.
+ * A channel idle for IDLE_MS is forgotten at the next flush; if it speaks
+ * again, its in-order mirror restarts at the message that arrives.
+ *
+ * The callback id doubles as the channel id, so the report can join these
+ * records with libspy's native eval_callback delivery latency.
+ */
+(function () {
+  "use strict";
+
+  var spy = window.__tauriSpy;
+  if (!spy || !spy.claim("ipc-channels")) return;
+
+  /* Stringify one object message in this many to estimate its size */
+  var SIZE_SAMPLE = 8;
+  var IDLE_MS = 30000;
+
+  var channels = Object.create(null);
+  var timer = null;
+
+  function sizeOf(message, state) {
+    if (message == null) return 0;
+    if (typeof message === "string") return message.length;
+    if (message instanceof ArrayBuffer) return message.byteLength;
+    if (ArrayBuffer.isView(message)) return message.byteLength;
+
+    state.sampleCountdown--;
+    if (state.sampleCountdown > 0) return state.lastSize;
+    state.sampleCountdown = SIZE_SAMPLE;
+    try {
+      state.lastSize = JSON.stringify(message).length;
+    } catch (e) {
+      state.lastSize = 0;
+    }
+    return state.lastSize;
+  }
+
+  function channelState(id) {
+    var state = channels[id];
+    if (!state) {
+      state = channels[id] = {
+        nextIndex: null,
+        lastSeen: 0,
+        ahead: Object.create(null),
+        aheadCount: 0,
+        sampleCountdown: 1,
+        lastSize: 0,
+        msgs: 0,
+        bytes: 0,
+        handlerMs: 0,
+        handlerMaxMs: 0,
+        reordered: 0,
+        lagMax: 0,
+        ended: false,
+      };
+    }
+    return state;
+  }
+
+  function flush() {
+    var active = false;
+    var t = spy.now();
+    for (var id in channels) {
+      var s = channels[id];
+      if (!s.msgs && !s.ended) {
+        if (t - s.lastSeen >= IDLE_MS) delete channels[id];
+        continue;
+      }
+      active = true;
+
+      spy.emit("ipc_channel", {
+        channel: Number(id),
+        msgs: s.msgs,
+        bytes: s.bytes,
+        handler_ms: spy.round(s.handlerMs),
+        handler_max_ms: spy.round(s.handlerMaxMs),
+        reordered: s.reordered,
+        /* Messages delivered ahead of the one the consumer waits for */
+        lag_max: s.lagMax,
+        ended: s.ended,
+      });
+
+      if (s.ended) {
+        delete channels[id];
+        continue;
+      }
+      s.msgs = s.bytes = s.handlerMs = s.handlerMaxMs = 0;
+      s.reordered = s.lagMax = 0;
+    }
+    if (!active) {
+      spy.clearInterval(timer);
+      timer = null;
+    }
+  }
+
+  function observe(id, payload, ms) {
+    var s = channelState(id);
+    var index = payload.index;
+
+    s.msgs++;
+    s.lastSeen = spy.now();
+    s.handlerMs += ms;
+    if (ms > s.handlerMaxMs) s.handlerMaxMs = ms;
+
+    if ("end" in payload) {
+      s.ended = true;
+    } else {
+      s.bytes += sizeOf(payload.message, s);
+    }
+
+    /* Mirror the consumer's in-order buffer */
+    if (s.nextIndex === null) s.nextIndex = index;
+    if (index === s.nextIndex) {
+      s.nextIndex++;
+      while (s.ahead[s.nextIndex]) {
+        delete s.ahead[s.nextIndex];
+        s.aheadCount--;
+        s.nextIndex++;
+      }
+    } else if (index > s.nextIndex && !s.ahead[index]) {
+      s.reordered++;
+      s.ahead[index] = true;
+      s.aheadCount++;
+    }
+    if (s.aheadCount > s.lagMax) s.lagMax = s.aheadCount;
+
+    if (!timer) timer = spy.setInterval(flush, 1000);
+  }
+
+  function isChannelPayload(payload) {
+    return (
+      payload !== null &&
+      typeof payload === "object" &&
+      typeof payload.index === "number" &&
+      ("message" in payload || "end" in payload)
+    );
+  }
+
+  function wrapTransformCallback(original) {
+    if (typeof original !== "function" || original.__tauriSpyWrapped) {
+      return original;
+    }
+
+    var wrapped = function (callback, once) {
+      if (once || typeof callback !== "function") {
+        return original.apply(this, arguments);
+      }
+
+      var id = null;
+      var observed = function (payload) {
+        if (id === null || !isChannelPayload(payload)) {
+          return callback.apply(this, arguments);
+        }
+        var start = spy.now();
+        try {
+          return callback.apply(this, arguments);
+        } finally {
+          observe(id, payload, spy.now() - start);
+        }
+      };
+      id = original.call(this, observed, once);
+      return id;
+    };
+    Object.defineProperty(wrapped, "__tauriSpyWrapped", { value: true });
+    return wrapped;
+  }
+
+  function instrument(internals) {
+    var descriptor = Object.getOwnPropertyDescriptor(
+      internals,
+      "transformCallback"
+    );
+    if (!descriptor || !("value" in descriptor)) return false;
+    if (!descriptor.writable && !descriptor.configurable) return false;
+
+    descriptor.value = wrapTransformCallback(descriptor.value);
+    Object.defineProperty(internals, "transformCallback", descriptor);
+    return true;
+  }
+
+  var internals = window.__TAURI_INTERNALS__;
+  if (internals && "transformCallback" in internals) {
+    if (!instrument(internals)) {
+      spy.emit("ipc_channel_unavailable", {
+        reason: "transformCallback is read-only",
+      });
+    }
+    return;
+  }
+
+  /*
+   * Tauri's init script creates __TAURI_INTERNALS__ and, in the same
+   * script, defines transformCallback on it as a read-only property.
+   * Running at document start ahead of it, catch the assignment of
+   * __TAURI_INTERNALS__; only then is Object.defineProperty() wrapped, to
+   * hand over the wrapped function, and only until that call or the end of
+   * the running script, whichever comes first.
+   */
+  var defineProperty = Object.defineProperty;
+  function shim(obj, key, descriptor) {
+    if (
+      key === "transformCallback" &&
+      obj === window.__TAURI_INTERNALS__ &&
+      descriptor &&
+      "value" in descriptor
+    ) {
+      Object.defineProperty = defineProperty;
+      descriptor = Object.assign({}, descriptor, {
+        value: wrapTransformCallback(descriptor.value),
+      });
+    }
+    return defineProperty.call(Object, obj, key, descriptor);
+  }
+
+  defineProperty(window, "__TAURI_INTERNALS__", {
+    get: function () {
+      return undefined;
+    },
+    set: function (value) {
+      defineProperty(window, "__TAURI_INTERNALS__", {
+        value: value,
+        writable: true,
+        enumerable: true,
+        configurable: true,
+      });
+      if (!value || typeof value !== "object") return;
+      if ("transformCallback" in value) {
+        instrument(value);
+        return;
+      }
+      Object.defineProperty = shim;
+      Promise.resolve().then(function () {
+        if (Object.defineProperty === shim) {
+          Object.defineProperty = defineProperty;
+        }
+      });
+    },
+    enumerable: false,
+    configurable: true,
+  });
+
+  /* Defined some other way (or Tauri never showed up): settle on load */
+  window.addEventListener("DOMContentLoaded", function () {
+    var late = window.__TAURI_INTERNALS__;
+    if (late && "transformCallback" in late) instrument(late);
+  });
+})();
+//# sourceURL=tauri-spy://probe/ipc-channels.js
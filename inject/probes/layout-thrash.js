@@ -0,0 +1,225 @@
+/*
+ * tauri-spy probe: layout-thrash
+ *
+ * A forced synchronous layout is a layout-reading property or method used
+ * after a DOM or style write in the same task: the engine has to lay the
+ * page out right there instead of once before the next frame. Wrap the
+ * common writes to mark layout dirty (until the next task, or until a read
+ * cleans it) and the common reads to catch the ones that find it dirty.
+ *
+ * Forced reads are timed and aggregated per call site once per second; the
+ * first record for a site carries its JS stack.
+ */
+(function () {
+  "use strict";
+
+  var spy = window.__tauriSpy;
+  if (!spy || !spy.claim("layout-thrash")) return;
+
+  var STACK_DEPTH = 8;
+
+  var now = spy.now;
+  var sites = Object.create(null);
+  var reported = Object.create(null);
+  var timer = null;
+
+  /* Layout state, as far as the wrapped APIs can tell */
+  var dirty = false;
+  var lastWrite = null;
+  var clearPending = false;
+  var clear = new MessageChannel();
+  clear.port1.onmessage = function () {
+    clearPending = false;
+    dirty = false;
+  };
+
+  function wrote(what) {
+    lastWrite = what;
+    if (dirty) return;
+    dirty = true;
+    if (!clearPending) {
+      clearPending = true;
+      clear.port2.postMessage(0);
+    }
+  }
+
+  function flush() {
+    var active = false;
+    for (var key in sites) {
+      var s = sites[key];
+      active = true;
+
+      var fields = {
+        site: s.site,
+        read: s.read,
+        write: s.write,
+        count: s.count,
+        ms: spy.round(s.ms),
+        max_ms: spy.round(s.maxMs),
+      };
+      if (!reported[key]) {
+        reported[key] = true;
+        fields.stack = s.stack;
+      }
+      spy.emit("layout_thrash", fields);
+    }
+    sites = Object.create(null);
+    if (!active) {
+      spy.clearInterval(timer);
+      timer = null;
+    }
+  }
+
+  function forced(what, ms) {
+    var stack = spy.stack(STACK_DEPTH);
+    var site = stack.length ? stack[0] : "(unknown)";
+    var key = site + "|" + what;
+
+    var s = sites[key];
+    if (!s) {
+      s = sites[key] = {
+        site: site,
+        read: what,
+        write: lastWrite,
+        stack: stack,
+        count: 0,
+        ms: 0,
+        maxMs: 0,
+      };
+    }
+    s.count++;
+    s.ms += ms;
+    if (ms > s.maxMs) s.maxMs = ms;
+
+    if (!timer) timer = spy.setInterval(flush, 1000);
+  }
+
+  function read(what, original, self, args) {
+    if (!dirty) return original.apply(self, args);
+
+    dirty = false; /* Whatever the read forces leaves layout clean */
+    var start = now();
+    try {
+      return original.apply(self, args);
+    } finally {
+      forced(what, now() - start);
+    }
+  }
+
+  /* Find the prototype (or object) that actually defines a property */
+  function owner(obj, name) {
+    while (obj && !Object.prototype.hasOwnProperty.call(obj, name)) {
+      obj = Object.getPrototypeOf(obj);
+    }
+    return obj;
+  }
+
+  function wrap(obj, name, field, make) {
+    var target = owner(obj, name);
+    if (!target) return;
+    var descriptor = Object.getOwnPropertyDescriptor(target, name);
+    if (!descriptor || typeof descriptor[field] !== "function") return;
+    if (!descriptor.configurable) return;
+
+    descriptor[field] = make(descriptor[field]);
+    Object.defineProperty(target, name, descriptor);
+  }
+
+  function wrapRead(obj, name, field, label) {
+    wrap(obj, name, field, function (original) {
+      return function () {
+        return read(label, original, this, arguments);
+      };
+    });
+  }
+
+  /* Writes to detached nodes don't touch layout; skip them */
+  function wrapNodeWrite(obj, name, field, label) {
+    wrap(obj, name, field, function (original) {
+      return function () {
+        if (this.isConnected) wrote(label);
+        return original.apply(this, arguments);
+      };
+    });
+  }
+
+  function wrapStyleWrite(obj, name, field, label) {
+    wrap(obj, name, field, function (original) {
+      return function () {
+        wrote(label);
+        return original.apply(this, arguments);
+      };
+    });
+  }
+
+  /* Reads */
+  [
+    "offsetTop",
+    "offsetLeft",
+    "offsetWidth",
+    "offsetHeight",
+    "offsetParent",
+    "innerText",
+  ].forEach(function (name) {
+    wrapRead(HTMLElement.prototype, name, "get", name);
+  });
+  [
+    "clientTop",
+    "clientLeft",
+    "clientWidth",
+    "clientHeight",
+    "scrollTop",
+    "scrollLeft",
+    "scrollWidth",
+    "scrollHeight",
+  ].forEach(function (name) {
+    wrapRead(Element.prototype, name, "get", name);
+  });
+  ["getBoundingClientRect", "getClientRects"].forEach(function (name) {
+    wrapRead(Element.prototype, name, "value", name + "()");
+  });
+  wrapRead(window, "getComputedStyle", "value", "getComputedStyle()");
+
+  /* DOM writes */
+  ["appendChild", "insertBefore", "removeChild", "replaceChild"].forEach(
+    function (name) {
+      wrapNodeWrite(Node.prototype, name, "value", name + "()");
+    }
+  );
+  wrapNodeWrite(Node.prototype, "textContent", "set", "textContent");
+  [
+    "setAttribute",
+    "removeAttribute",
+    "toggleAttribute",
+    "append",
+    "prepend",
+    "remove",
+    "before",
+    "after",
+    "replaceWith",
+    "insertAdjacentHTML",
+    "insertAdjacentElement",
+  ].forEach(function (name) {
+    wrapNodeWrite(Element.prototype, name, "value", name + "()");
+  });
+  ["innerHTML", "outerHTML", "className"].forEach(function (name) {
+    wrapNodeWrite(Element.prototype, name, "set", name);
+  });
+  ["add", "remove", "toggle", "replace"].forEach(function (name) {
+    var label = "classList." + name + "()";
+    wrapStyleWrite(DOMTokenList.prototype, name, "value", label);
+  });
+
+  /* Style writes: setProperty() and every style.foo = ... accessor */
+  var style = CSSStyleDeclaration.prototype;
+  ["setProperty", "removeProperty"].forEach(function (name) {
+    wrapStyleWrite(style, name, "value", "style." + name + "()");
+  });
+  Object.getOwnPropertyNames(style).forEach(function (name) {
+    var descriptor = Object.getOwnPropertyDescriptor(style, name);
+    if (descriptor && descriptor.set) {
+      wrapStyleWrite(style, name, "set", "style." + name);
+    }
+  });
+})();
+//# sourceURL=tauri-spy://probe/layout-thrash.js
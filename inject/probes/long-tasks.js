@@ -0,0 +1,171 @@
+/*
+ * tauri-spy probe: long-tasks
+ *
+ * WebKitGTK has no Long Tasks API, so main-thread blocks are inferred from
+ * the outside: a MessageChannel heartbeat every HEARTBEAT_MS measures how
+ * long a queued task (and the timer between pings) waits, and a
+ * requestAnimationFrame loop measures gaps between frames. Overlapping
+ * detections are merged into one block.
+ *
+ * Neither may keep an idle page busy: both stop while the page is hidden,
+ * and the frame loop runs only for ACTIVE_MS after input, DOM changes or a
+ * block the heartbeat caught, which is when the page is producing frames.
+ *
+ * Blocked code can't be sampled from JS, so each block is attributed to the
+ * script most likely running: one whose download finished right before or
+ * during the block, or a <script> inserted while it lasted. Mutation records
+ * for a parser-inserted script are delivered once it has run, so its
+ * insertion lands inside the block it caused.
+ */
+(function () {
+  "use strict";
+
+  var spy = window.__tauriSpy;
+  if (!spy || !spy.claim("long-tasks")) return;
+
+  var BLOCK_MS = 50;
+  var HEARTBEAT_MS = 100;
+  var FRAME_MS = 1000 / 60;
+  var ACTIVE_MS = 1000;
+
+  var now = spy.now;
+  var raf = spy.raf;
+  var setTimer = spy.setTimeout;
+
+  var lastBlockEnd = 0;
+  var lastInserted = null;
+  var inlineCount = 0;
+
+  function scriptName(script) {
+    if (script.src) return script.src;
+    if (!script.__tauriSpyName) {
+      script.__tauriSpyName = location.href + "#inline-" + ++inlineCount;
+    }
+    return script.__tauriSpyName;
+  }
+
+  function attribute(start, end) {
+    /* Script resources that finished arriving just before or during it */
+    var entries = performance.getEntriesByType("resource");
+    for (var i = entries.length - 1; i >= 0; i--) {
+      var e = entries[i];
+      if (e.initiatorType !== "script") continue;
+      if (e.responseEnd >= start - FRAME_MS && e.responseEnd <= end) {
+        return { script: e.name, by: "loaded" };
+      }
+    }
+
+    if (lastInserted && lastInserted.time >= start - FRAME_MS) {
+      return { script: lastInserted.name, by: "inserted" };
+    }
+    return { script: null, by: "none" };
+  }
+
+  /* True if the block is new; overlaps and short gaps return false */
+  function block(start, end, detector) {
+    if (end <= lastBlockEnd) return false; /* Reported by the other one */
+    if (start < lastBlockEnd) start = lastBlockEnd;
+
+    var duration = end - start;
+    if (duration < BLOCK_MS) return false;
+    lastBlockEnd = end;
+
+    var who = attribute(start, end);
+    spy.emit("long_task", {
+      start_ms: spy.round(start),
+      dur_ms: spy.round(duration),
+      detector: detector,
+      script: who.script,
+      attributed_by: who.by,
+      visible: document.visibilityState === "visible",
+    });
+    return true;
+  }
+
+  /*
+   * Heartbeat: the pong task waits behind whatever is blocking while a ping
+   * is in flight; between pings, the timer that sends the next one fires
+   * late. Hidden pages have their timers throttled, so lateness only counts
+   * while visible.
+   */
+  var channel = new MessageChannel();
+  var sentAt = 0;
+  var scheduledAt = 0;
+  var beating = false;
+  channel.port1.onmessage = function () {
+    if (block(sentAt, now(), "heartbeat")) active();
+    if (document.visibilityState === "hidden") {
+      beating = false;
+      return;
+    }
+    scheduledAt = now();
+    setTimer(ping, HEARTBEAT_MS);
+  };
+  function ping() {
+    sentAt = now();
+    var late = sentAt - scheduledAt - HEARTBEAT_MS;
+    if (scheduledAt && document.visibilityState === "visible") {
+      if (block(sentAt - late, sentAt, "heartbeat")) active();
+    }
+    channel.port2.postMessage(0);
+  }
+
+  function startHeartbeat() {
+    if (beating || document.visibilityState === "hidden") return;
+    beating = true;
+    scheduledAt = 0; /* The pause was not a late timer */
+    ping();
+  }
+
+  /* Frame gaps: only meaningful while frames are being produced */
+  var lastFrame = 0;
+  var lastActive = 0;
+  var looping = false;
+  function onFrame(time) {
+    if (lastFrame && time - lastFrame > BLOCK_MS + FRAME_MS) {
+      block(lastFrame + FRAME_MS, time, "frame");
+    }
+    lastFrame = time;
+    var hidden = document.visibilityState === "hidden";
+    if (hidden || now() - lastActive > ACTIVE_MS) {
+      looping = false;
+      lastFrame = 0;
+      return;
+    }
+    raf(onFrame);
+  }
+
+  function active() {
+    lastActive = now();
+    if (looping || document.visibilityState === "hidden") return;
+    looping = true;
+    raf(onFrame);
+  }
+
+  ["keydown", "pointerdown", "pointermove", "wheel", "touchstart"].forEach(
+    function (type) {
+      window.addEventListener(type, active, { capture: true, passive: true });
+    }
+  );
+  document.addEventListener("visibilitychange", function () {
+    lastFrame = 0; /* Hidden pages don't get frames; not a block */
+    startHeartbeat();
+    active();
+  });
+
+  new MutationObserver(function (mutations) {
+    active();
+    for (var i = 0; i < mutations.length; i++) {
+      var added = mutations[i].addedNodes;
+      for (var j = 0; j < added.length; j++) {
+        if (added[j].nodeName === "SCRIPT") {
+          lastInserted = { name: scriptName(added[j]), time: now() };
+        }
+      }
+    }
+  }).observe(document, { childList: true, subtree: true });
+
+  startHeartbeat();
+  active();
+})();
+//# sourceURL=tauri-spy://probe/long-tasks.js
@@ -0,0 +1,159 @@
+/*
+ * tauri-spy probe: raf
+ *
+ * Wrap requestAnimationFrame() and time every callback against the call
+ * site that registered it. Callbacks run in the same frame receive the same
+ * timestamp, which groups them into frames; a frame whose rAF work alone
+ * takes more than FRAME_BUDGET_MS leaves nothing for style, layout and
+ * paint, and is reported on its own with its costliest sites.
+ *
+ * Once per second: frames with rAF work, callbacks per frame, time spent and
+ * the per-site breakdown. The first record naming a site carries its stack.
+ */
+(function () {
+  "use strict";
+
+  var spy = window.__tauriSpy;
+  if (!spy || !spy.claim("raf")) return;
+
+  var FRAME_BUDGET_MS = 1000 / 60;
+  var STACK_DEPTH = 6;
+  var OVERRUN_SITES = 3;
+
+  var now = spy.now;
+  var originalRaf = window.requestAnimationFrame;
+
+  var reported = Object.create(null);
+  var timer = null;
+
+  /* Current frame */
+  var frameTime = null;
+  var frameMs = 0;
+  var frameCallbacks = 0;
+  var frameSites = Object.create(null);
+
+  /* Current second */
+  var second = null;
+
+  function emptySecond() {
+    return {
+      frames: 0,
+      callbacks: 0,
+      maxPerFrame: 0,
+      ms: 0,
+      maxFrameMs: 0,
+      overBudget: 0,
+      sites: Object.create(null),
+    };
+  }
+
+  var round = spy.round;
+
+  function closeFrame() {
+    if (frameTime === null) return;
+    var s = second || (second = emptySecond());
+
+    s.frames++;
+    s.ms += frameMs;
+    if (frameCallbacks > s.maxPerFrame) s.maxPerFrame = frameCallbacks;
+    if (frameMs > s.maxFrameMs) s.maxFrameMs = frameMs;
+
+    if (frameMs > FRAME_BUDGET_MS) {
+      s.overBudget++;
+      var costly = [];
+      for (var site in frameSites) {
+        costly.push([site, round(frameSites[site])]);
+      }
+      costly.sort(function (a, b) {
+        return b[1] - a[1];
+      });
+      spy.emit("raf_overrun", {
+        frame_ms: round(frameMs),
+        callbacks: frameCallbacks,
+        sites: costly.slice(0, OVERRUN_SITES),
+      });
+    }
+
+    frameTime = null;
+    frameMs = 0;
+    frameCallbacks = 0;
+    frameSites = Object.create(null);
+  }
+
+  function flush() {
+    closeFrame();
+    var s = second;
+    second = null;
+    if (!s) {
+      spy.clearInterval(timer);
+      timer = null;
+      return;
+    }
+
+    var sites = [];
+    var stacks = {};
+    for (var key in s.sites) {
+      var site = s.sites[key];
+      sites.push([key, site.calls, round(site.ms), round(site.maxMs)]);
+      if (!reported[key]) {
+        reported[key] = true;
+        stacks[key] = site.stack;
+      }
+    }
+    spy.emit("raf_frames", {
+      frames: s.frames,
+      callbacks: s.callbacks,
+      max_per_frame: s.maxPerFrame,
+      ms: round(s.ms),
+      max_frame_ms: round(s.maxFrameMs),
+      over_budget: s.overBudget,
+      sites: sites,
+      stacks: stacks,
+    });
+  }
+
+  function ran(site, timestamp, ms) {
+    if (timestamp !== frameTime) {
+      closeFrame();
+      frameTime = timestamp;
+    }
+    frameMs += ms;
+    frameCallbacks++;
+    frameSites[site.site] = (frameSites[site.site] || 0) + ms;
+
+    var s = second || (second = emptySecond());
+    s.callbacks++;
+    var entry = s.sites[site.site];
+    if (!entry) {
+      entry = s.sites[site.site] = {
+        calls: 0,
+        ms: 0,
+        maxMs: 0,
+        stack: site.stack,
+      };
+    }
+    entry.calls++;
+    entry.ms += ms;
+    if (ms > entry.maxMs) entry.maxMs = ms;
+
+    if (!timer) timer = spy.setInterval(flush, 1000);
+  }
+
+  window.requestAnimationFrame = function (callback) {
+    var site =
+      typeof callback === "function"
+        ? spy.callSite(callback, STACK_DEPTH)
+        : null;
+    if (!site) return originalRaf.call(window, callback);
+
+    return originalRaf.call(window, function (timestamp) {
+      var start = now();
+      try {
+        return callback.apply(this, arguments);
+      } finally {
+        ran(site, timestamp, now() - start);
+      }
+    });
+  };
+})();
+//# sourceURL=tauri-spy://probe/raf.js
@@ -0,0 +1,188 @@
+/*
+ * tauri-spy probe: scroll-listeners
+ *
+ * Wrap addEventListener() to find wheel and touch listeners that defeat
+ * async scrolling. WebKit can only scroll on its own thread when no
+ * non-passive listener for the event is registered; otherwise every wheel
+ * or touchmove waits for the main thread to run the handlers, in case one of
+ * them calls preventDefault(). Listeners on window, document and <body>
+ * default to passive when the page doesn't say, as in WebKit.
+ *
+ * Every wheel, mousewheel, touchstart, touchmove and scroll registration is
+ * recorded once per call site, target and type as "scroll_listener", with
+ * whether it is passive and its stack. Handlers are timed; once per second a
+ * "scroll_handlers" record lists the sites that ran, with how often they
+ * actually prevented the default. Scroll listeners never block scrolling
+ * but slow ones still delay the next frame.
+ */
+(function () {
+  "use strict";
+
+  var spy = window.__tauriSpy;
+  if (!spy || !spy.claim("scroll-listeners")) return;
+
+  var TYPES = /^(wheel|mousewheel|touchstart|touchmove|scroll)$/;
+  var BLOCKING = /^(wheel|mousewheel|touchstart|touchmove)$/;
+  var STACK_DEPTH = 6;
+
+  var now = spy.now;
+  var proto = EventTarget.prototype;
+  var originalAdd = proto.addEventListener;
+  var originalRemove = proto.removeEventListener;
+
+  var wrappers = new WeakMap(); /* listener -> target -> {key: wrapper} */
+  var registered = Object.create(null);
+  var sites = Object.create(null);
+  var timer = null;
+
+  function describe(target) {
+    if (target === window) return "window";
+    if (target === document) return "document";
+    if (!target || target.nodeType !== 1) return String(target);
+    var name = target.localName;
+    if (target.id) return name + "#" + target.id;
+    var className = target.getAttribute("class");
+    if (className) {
+      name += "." + className.trim().split(/\s+/).slice(0, 2).join(".");
+    }
+    return name;
+  }
+
+  function isRoot(target) {
+    return (
+      target === window || target === document || target === document.body
+    );
+  }
+
+  function capture(options) {
+    return typeof options === "object" && options !== null
+      ? !!options.capture
+      : !!options;
+  }
+
+  /* {passive, explicit} as WebKit would treat the registration */
+  function passivity(type, target, options) {
+    if (typeof options === "object" && options && "passive" in options) {
+      return { passive: !!options.passive, explicit: true };
+    }
+    if (!BLOCKING.test(type)) return { passive: true, explicit: false };
+    var root = type !== "mousewheel" && isRoot(target);
+    return { passive: root, explicit: false };
+  }
+
+  function flush() {
+    var rows = [];
+    for (var key in sites) {
+      var s = sites[key];
+      rows.push([
+        s.site,
+        s.type,
+        s.passive,
+        s.calls,
+        spy.round(s.ms),
+        spy.round(s.maxMs),
+        s.prevented,
+      ]);
+    }
+    sites = Object.create(null);
+    if (!rows.length) {
+      spy.clearInterval(timer);
+      timer = null;
+      return;
+    }
+    spy.emit("scroll_handlers", { sites: rows });
+  }
+
+  /* prevented: this listener called preventDefault(), not an earlier one */
+  function ran(info, ms, prevented) {
+    var key = info.site + "\n" + info.type;
+    var s = sites[key];
+    if (!s) {
+      s = sites[key] = {
+        site: info.site,
+        type: info.type,
+        passive: info.passive,
+        calls: 0,
+        ms: 0,
+        maxMs: 0,
+        prevented: 0,
+      };
+    }
+    s.calls++;
+    s.ms += ms;
+    if (ms > s.maxMs) s.maxMs = ms;
+    if (prevented && !info.passive) s.prevented++;
+    if (!timer) timer = spy.setInterval(flush, 1000);
+  }
+
+  function wrap(listener, info) {
+    return function (event) {
+      var wasPrevented = event.defaultPrevented;
+      var start = now();
+      try {
+        if (typeof listener === "function") {
+          return listener.apply(this, arguments);
+        }
+        return listener.handleEvent(event);
+      } finally {
+        ran(info, now() - start, !wasPrevented && event.defaultPrevented);
+      }
+    };
+  }
+
+  proto.addEventListener = function (type, listener, options) {
+    var stack;
+    if (
+      !TYPES.test(type) ||
+      !listener ||
+      (typeof listener !== "function" && typeof listener !== "object") ||
+      !(stack = spy.stack(STACK_DEPTH)).length
+    ) {
+      return originalAdd.apply(this, arguments);
+    }
+
+    var key = type + (capture(options) ? ":capture" : "");
+    var byTarget = wrappers.get(listener);
+    if (!byTarget) wrappers.set(listener, (byTarget = new WeakMap()));
+    var byKey = byTarget.get(this);
+    if (!byKey) byTarget.set(this, (byKey = Object.create(null)));
+    /* Same listener twice is a no-op in the DOM; keep one wrapper */
+    var wrapper = byKey[key];
+    if (!wrapper) {
+      var p = passivity(type, this, options);
+      var info = { site: stack[0], type: type, passive: p.passive };
+      wrapper = byKey[key] = wrap(listener, info);
+
+      var target = describe(this);
+      var id = [info.site, type, target].join("\n");
+      if (!registered[id]) {
+        registered[id] = true;
+        spy.emit("scroll_listener", {
+          type: type,
+          target: target,
+          passive: p.passive,
+          explicit: p.explicit,
+          capture: capture(options),
+          site: info.site,
+          stack: stack,
+        });
+      }
+    }
+
+    var args = Array.prototype.slice.call(arguments);
+    args[1] = wrapper;
+    return originalAdd.apply(this, args);
+  };
+
+  proto.removeEventListener = function (type, listener, options) {
+    var byTarget = listener && wrappers.get(listener);
+    var byKey = byTarget && byTarget.get(this);
+    var key = type + (capture(options) ? ":capture" : "");
+    if (!byKey || !byKey[key]) return originalRemove.apply(this, arguments);
+
+    var args = Array.prototype.slice.call(arguments);
+    args[1] = byKey[key];
+    return originalRemove.apply(this, args);
+  };
+})();
+//# sourceURL=tauri-spy://probe/scroll-listeners.js
@@ -0,0 +1,113 @@
+/*
+ * tauri-spy probe: source-maps
+ *
+ * Fetch the source maps of the page's scripts through the app's own asset
+ * scheme, so `tauri-spy report` can resolve minified stack frames without a
+ * copy of the build. Every script the page loads (its resource timing
+ * entries) is fetched again, from the asset handler rather than the
+ * network, and its SourceMap header or last sourceMappingURL comment is
+ * followed; inline data: maps work the same way.
+ *
+ * Scripts are fetched one at a time, starting FETCH_DELAY_MS after the load
+ * event so startup measurements stay clean; chunks loaded later are picked
+ * up as they appear. Each map found is recorded once as "srcmap" with the
+ * script URL and the map's JSON text. A map over MAX_MAP_CHARS is recorded
+ * without its text, and the report says so.
+ */
+(function () {
+  "use strict";
+
+  var spy = window.__tauriSpy;
+  if (!spy || !window.fetch || !spy.claim("source-maps")) return;
+
+  var FETCH_DELAY_MS = 2000;
+  var MAX_MAP_CHARS = 32 * 1024 * 1024;
+
+  var SCRIPT_URL = /\.m?js([?#]|$)/;
+  var COMMENT = /[#@]\s*sourceMappingURL=(\S+)\s*$/;
+
+  var fetch = window.fetch.bind(window);
+  var seen = Object.create(null);
+  var queue = [];
+  var started = false;
+  var busy = false;
+
+  function mapUrlOf(response, source) {
+    var header =
+      response.headers.get("SourceMap") || response.headers.get("X-SourceMap");
+    if (header) return header;
+    var tail = source.slice(-4096).trimEnd();
+    var match = COMMENT.exec(tail.slice(tail.lastIndexOf("\n") + 1));
+    return match ? match[1] : null;
+  }
+
+  function record(url, mapUrl, map) {
+    var tooLarge = map.length > MAX_MAP_CHARS;
+    spy.emit("srcmap", {
+      url: url,
+      map_url: mapUrl.indexOf("data:") === 0 ? "(inline)" : mapUrl,
+      chars: map.length,
+      map: tooLarge ? null : map,
+    });
+  }
+
+  function next() {
+    if (busy || !started || !queue.length) return;
+    busy = true;
+    var url = queue.shift();
+    var mapUrl = null;
+
+    fetch(url)
+      .then(function (response) {
+        return response.text().then(function (source) {
+          var found = response.ok && mapUrlOf(response, source);
+          if (!found) return null;
+          mapUrl = new URL(found, url).href;
+          return fetch(mapUrl).then(function (map) {
+            return map.ok ? map.text() : null;
+          });
+        });
+      })
+      .then(function (map) {
+        if (map) record(url, mapUrl, map);
+      })
+      .catch(function () {
+        /* Not fetchable from the page; --source-maps can still cover it */
+      })
+      .then(function () {
+        busy = false;
+        next();
+      });
+  }
+
+  function consider(entry) {
+    var url = entry.name;
+    if (seen[url] || url.indexOf("tauri-spy://") === 0) return;
+    if (url.indexOf("data:") === 0 || url.indexOf("blob:") === 0) return;
+    if (entry.initiatorType !== "script" && !SCRIPT_URL.test(url)) return;
+    seen[url] = true;
+    queue.push(url);
+    next();
+  }
+
+  function start() {
+    started = true;
+    next();
+  }
+
+  if (window.PerformanceObserver) {
+    new PerformanceObserver(function (list) {
+      list.getEntries().forEach(consider);
+    }).observe({ type: "resource", buffered: true });
+  } else {
+    performance.getEntriesByType("resource").forEach(consider);
+  }
+
+  function schedule() {
+    spy.setTimeout(start, FETCH_DELAY_MS);
+  }
+
+  if (document.readyState === "complete") schedule();
+  else window.addEventListener("load", schedule);
+})();
+//# sourceURL=tauri-spy://probe/source-maps.js
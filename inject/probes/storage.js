@@ -0,0 +1,208 @@
+/*
+ * tauri-spy probe: storage
+ *
+ * Time synchronous storage access: the Storage methods of localStorage and
+ * sessionStorage (getItem, setItem, removeItem, clear, key), and
+ * document.cookie reads and writes. Named property access (storage.token,
+ * storage["token"]) is not timed: seeing it would take a Proxy in place of
+ * the real Storage object, and that breaks identity checks such as
+ * event.storageArea === localStorage. The first access to a storage area
+ * makes WebKit load the whole area from the storage process, and that can
+ * hit disk; it is recorded as "storage_first_access".
+ *
+ * Sizes are the UTF-16 bytes of key and value, as WebKit stores them. Until
+ * the load event the page is starting up; a read of LARGE_BYTES or more in
+ * that time is reported on its own as "storage_large_read" with its stack.
+ * Once per second a "storage" record gives, per area and key, reads and
+ * writes with their bytes and the time they took, and whether the page was
+ * still starting up.
+ */
+(function () {
+  "use strict";
+
+  var spy = window.__tauriSpy;
+  if (!spy || !window.Storage || !spy.claim("storage")) return;
+
+  var LARGE_BYTES = 64 * 1024;
+  var TOP_KEYS = 50;
+  var STACK_DEPTH = 6;
+
+  var now = spy.now;
+  var proto = Storage.prototype;
+  var starting = document.readyState !== "complete";
+  var areas = new WeakMap(); /* Storage -> "localStorage" | ... | null */
+  var opened = Object.create(null);
+  var reportedLarge = Object.create(null);
+  var keys = Object.create(null);
+  var timer = null;
+
+  window.addEventListener("load", function () {
+    starting = false;
+  });
+
+  function findDescriptor(object, name) {
+    for (var o = object; o; o = Object.getPrototypeOf(o)) {
+      var descriptor = Object.getOwnPropertyDescriptor(o, name);
+      if (descriptor) return { owner: o, descriptor: descriptor };
+    }
+    return null;
+  }
+
+  var round = spy.round;
+
+  function flush() {
+    var rows = [];
+    for (var id in keys) {
+      var k = keys[id];
+      rows.push([
+        k.area,
+        k.key,
+        k.reads,
+        k.readBytes,
+        k.writes,
+        k.writeBytes,
+        round(k.ms),
+        round(k.maxMs),
+        k.starting,
+      ]);
+    }
+    keys = Object.create(null);
+    if (!rows.length) {
+      spy.clearInterval(timer);
+      timer = null;
+      return;
+    }
+    rows.sort(function (a, b) {
+      return b[6] - a[6];
+    });
+    spy.emit("storage", {
+      keys: rows.length,
+      items: rows.slice(0, TOP_KEYS),
+    });
+  }
+
+  function record(area, key, write, bytes, ms) {
+    if (!opened[area]) {
+      opened[area] = true;
+      spy.emit("storage_first_access", {
+        area: area,
+        key: key,
+        ms: round(ms),
+        starting: starting,
+      });
+    }
+
+    var id = area + "\n" + key;
+    var k = keys[id + "\n" + starting];
+    if (!k) {
+      k = keys[id + "\n" + starting] = {
+        area: area,
+        key: key,
+        starting: starting,
+        reads: 0,
+        readBytes: 0,
+        writes: 0,
+        writeBytes: 0,
+        ms: 0,
+        maxMs: 0,
+      };
+    }
+    if (write) {
+      k.writes++;
+      k.writeBytes += bytes;
+    } else {
+      k.reads++;
+      k.readBytes += bytes;
+    }
+    k.ms += ms;
+    if (ms > k.maxMs) k.maxMs = ms;
+    if (!timer) timer = spy.setInterval(flush, 1000);
+
+    if (!write && starting && bytes >= LARGE_BYTES && !reportedLarge[id]) {
+      reportedLarge[id] = true;
+      var stack = spy.stack(STACK_DEPTH);
+      spy.emit("storage_large_read", {
+        area: area,
+        key: key,
+        bytes: bytes,
+        ms: round(ms),
+        site: stack[0] || null,
+        stack: stack,
+      });
+    }
+  }
+
+  function size(value) {
+    return typeof value === "string" ? value.length * 2 : 0;
+  }
+
+  /* Which of the window's areas a Storage object is, looked up once */
+  function areaOf(storage) {
+    var area = areas.get(storage);
+    if (area !== undefined) return area;
+    area = null;
+    try {
+      if (storage === window.localStorage) area = "localStorage";
+      else if (storage === window.sessionStorage) area = "sessionStorage";
+    } catch (e) {
+      /* Opaque origins throw SecurityError */
+    }
+    areas.set(storage, area);
+    return area;
+  }
+
+  function wrapMethod(name, measure) {
+    var original = proto[name];
+    proto[name] = function () {
+      var area = this instanceof Storage ? areaOf(this) : null;
+      if (!area) return original.apply(this, arguments);
+      var start = now();
+      var result = original.apply(this, arguments);
+      var ms = now() - start;
+      measure(area, arguments, result, ms);
+      return result;
+    };
+  }
+
+  wrapMethod("getItem", function (area, args, result, ms) {
+    var key = String(args[0]);
+    record(area, key, false, size(key) + size(result), ms);
+  });
+  wrapMethod("setItem", function (area, args, result, ms) {
+    var key = String(args[0]);
+    record(area, key, true, size(key) + size(String(args[1])), ms);
+  });
+  wrapMethod("removeItem", function (area, args, result, ms) {
+    record(area, String(args[0]), true, 0, ms);
+  });
+  wrapMethod("clear", function (area, args, result, ms) {
+    record(area, "(clear)", true, 0, ms);
+  });
+  wrapMethod("key", function (area, args, result, ms) {
+    record(area, "(key)", false, size(result), ms);
+  });
+
+  var cookie = findDescriptor(document, "cookie");
+  if (cookie && cookie.descriptor.configurable && cookie.descriptor.get) {
+    var getCookie = cookie.descriptor.get;
+    var setCookie = cookie.descriptor.set;
+    Object.defineProperty(cookie.owner, "cookie", {
+      get: function () {
+        var start = now();
+        var value = getCookie.call(this);
+        record("cookie", "(all)", false, size(value), now() - start);
+        return value;
+      },
+      set: function (value) {
+        var start = now();
+        setCookie.call(this, value);
+        var text = String(value);
+        var name = text.split("=")[0].trim();
+        record("cookie", name, true, size(text), now() - start);
+      },
+      enumerable: cookie.descriptor.enumerable,
+      configurable: true,
+    });
+  }
+})();
+//# sourceURL=tauri-spy://probe/storage.js
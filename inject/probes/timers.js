@@ -0,0 +1,157 @@
+/*
+ * tauri-spy probe: timers
+ *
+ * Wrap setTimeout(), setInterval() and requestAnimationFrame() to find the
+ * call sites that keep waking the page up. Every callback is attributed to
+ * the JS call site that registered it and timed; fires are also counted
+ * separately while the app is idle, meaning hidden or without user input for
+ * IDLE_MS.
+ *
+ * Records cover the time since the previous one (span_ms), of which idle_ms
+ * was idle, and list every site that fired in it. The first record naming a
+ * site also carries its stack.
+ */
+(function () {
+  "use strict";
+
+  var spy = window.__tauriSpy;
+  if (!spy || !spy.claim("timers")) return;
+
+  var IDLE_MS = 5000;
+  var STACK_DEPTH = 6;
+
+  var now = spy.now;
+  var originalSetTimeout = window.setTimeout;
+  var originalSetInterval = window.setInterval;
+  var originalRaf = window.requestAnimationFrame;
+
+  var sites = Object.create(null);
+  var reported = Object.create(null);
+  var timer = null;
+  var lastFlush = now();
+
+  var lastInput = now();
+  var hiddenSince = document.visibilityState === "hidden" ? now() : null;
+
+  function idleSince() {
+    if (hiddenSince !== null) return hiddenSince;
+    return lastInput + IDLE_MS;
+  }
+
+  function isIdle() {
+    return now() >= idleSince();
+  }
+
+  ["keydown", "pointerdown", "pointermove", "wheel", "touchstart"].forEach(
+    function (type) {
+      window.addEventListener(
+        type,
+        function () {
+          lastInput = now();
+        },
+        { capture: true, passive: true }
+      );
+    }
+  );
+  document.addEventListener("visibilitychange", function () {
+    hiddenSince = document.visibilityState === "hidden" ? now() : null;
+    lastInput = now();
+  });
+
+  function flush() {
+    var t = now();
+    var list = [];
+    var stacks = {};
+    for (var key in sites) {
+      var s = sites[key];
+      list.push([
+        s.site,
+        s.api,
+        s.fires,
+        spy.round(s.ms),
+        s.idleFires,
+        spy.round(s.idleMs),
+        s.delay,
+      ]);
+      if (!reported[s.site]) {
+        reported[s.site] = true;
+        stacks[s.site] = s.stack;
+      }
+    }
+    sites = Object.create(null);
+
+    var span = t - lastFlush;
+    var idle = t - Math.max(idleSince(), lastFlush);
+    lastFlush = t;
+
+    if (!list.length) {
+      spy.clearInterval(timer);
+      timer = null;
+      return;
+    }
+    spy.emit("timers", {
+      span_ms: Math.round(span),
+      idle_ms: Math.round(idle > 0 ? idle : 0),
+      sites: list,
+      stacks: stacks,
+    });
+  }
+
+  function tally(site, api, delay, ms) {
+    var key = api + "|" + site.site;
+    var s = sites[key];
+    if (!s) {
+      s = sites[key] = {
+        site: site.site,
+        stack: site.stack,
+        api: api,
+        delay: delay,
+        fires: 0,
+        ms: 0,
+        idleFires: 0,
+        idleMs: 0,
+      };
+    }
+    s.fires++;
+    s.ms += ms;
+    if (isIdle()) {
+      s.idleFires++;
+      s.idleMs += ms;
+    }
+
+    /* Quiet stretches without a record still count towards the next span */
+    if (!timer) timer = spy.setInterval(flush, 1000);
+  }
+
+  function timed(callback, api, delay) {
+    if (typeof callback !== "function") return callback;
+    var site = spy.callSite(callback, STACK_DEPTH);
+    if (!site) return callback;
+
+    return function () {
+      var start = now();
+      try {
+        return callback.apply(this, arguments);
+      } finally {
+        tally(site, api, delay, now() - start);
+      }
+    };
+  }
+
+  window.setTimeout = function (callback, delay) {
+    var args = Array.prototype.slice.call(arguments);
+    args[0] = timed(callback, "setTimeout", delay | 0);
+    return originalSetTimeout.apply(window, args);
+  };
+
+  window.setInterval = function (callback, delay) {
+    var args = Array.prototype.slice.call(arguments);
+    args[0] = timed(callback, "setInterval", delay | 0);
+    return originalSetInterval.apply(window, args);
+  };
+
+  window.requestAnimationFrame = function (callback) {
+    return originalRaf.call(window, timed(callback, "rAF", 0));
+  };
+})();
+//# sourceURL=tauri-spy://probe/timers.js
@@ -0,0 +1,196 @@
+/*
+ * tauri-spy probe: wasm
+ *
+ * Wrap WebAssembly.compile(), instantiate(), compileStreaming(),
+ * instantiateStreaming() and the synchronous Module and Instance
+ * constructors. Calls that compile and instantiate in one go are split into
+ * a compile followed by an instantiate of the compiled module, so each
+ * phase is timed on its own; the result handed back is the same.
+ *
+ * Every call is recorded as a "wasm" record once it settles: the API, the
+ * module size (from the buffer, or for streaming from Content-Length or
+ * resource timing), compile and instantiate time, whether it streamed or
+ * blocked the main thread, and the error if it failed. A streaming compile
+ * rejected for its MIME type is the usual sign the app falls back to
+ * buffering the whole module.
+ */
+(function () {
+  "use strict";
+
+  var spy = window.__tauriSpy;
+  var wasm = window.WebAssembly;
+  if (!spy || !wasm || !spy.claim("wasm")) return;
+
+  var STACK_DEPTH = 6;
+
+  var now = spy.now;
+  var original = {
+    compile: wasm.compile,
+    instantiate: wasm.instantiate,
+    compileStreaming: wasm.compileStreaming,
+    instantiateStreaming: wasm.instantiateStreaming,
+    Module: wasm.Module,
+    Instance: wasm.Instance,
+  };
+
+  var round = spy.round;
+
+  function begin(api, streaming, sync) {
+    return {
+      api: api,
+      streaming: streaming,
+      sync: sync,
+      site: spy.stack(STACK_DEPTH)[0] || null,
+      start: now(),
+      url: null,
+      bytes: null,
+      compileMs: null,
+      instantiateMs: null,
+    };
+  }
+
+  function finish(call, error) {
+    if (call.url && call.bytes === null) {
+      var entries = performance.getEntriesByName(call.url, "resource");
+      var entry = entries[entries.length - 1];
+      if (entry) call.bytes = entry.decodedBodySize || null;
+    }
+    spy.emit("wasm", {
+      api: call.api,
+      streaming: call.streaming,
+      sync: call.sync,
+      url: call.url,
+      bytes: call.bytes,
+      started_ms: round(call.start),
+      compile_ms: round(call.compileMs),
+      instantiate_ms: round(call.instantiateMs),
+      error: error ? String(error) : null,
+      site: call.site,
+    });
+  }
+
+  function sizeOf(bytes) {
+    if (bytes instanceof ArrayBuffer || ArrayBuffer.isView(bytes)) {
+      return bytes.byteLength;
+    }
+    return null;
+  }
+
+  /* Size and URL from the Response without touching its body */
+  function fromResponse(call, source) {
+    Promise.resolve(source).then(
+      function (response) {
+        call.url = response.url || null;
+        var length = Number(response.headers.get("content-length"));
+        if (length) call.bytes = length;
+      },
+      function () {}
+    );
+  }
+
+  function compiled(call, promise) {
+    return promise.then(function (module) {
+      call.compileMs = now() - call.start;
+      return module;
+    });
+  }
+
+  function instantiated(call, module, imports) {
+    var start = now();
+    return original.instantiate
+      .call(wasm, module, imports)
+      .then(function (instance) {
+        call.instantiateMs = now() - start;
+        return instance;
+      });
+  }
+
+  function settle(call, promise) {
+    return promise.then(
+      function (result) {
+        finish(call, null);
+        return result;
+      },
+      function (error) {
+        finish(call, error);
+        throw error;
+      }
+    );
+  }
+
+  wasm.compile = function (bytes) {
+    var call = begin("compile", false, false);
+    call.bytes = sizeOf(bytes);
+    var module = original.compile.apply(wasm, arguments);
+    return settle(call, compiled(call, module));
+  };
+
+  wasm.instantiate = function (source, imports) {
+    var call = begin("instantiate", false, false);
+    if (source instanceof original.Module) {
+      return settle(call, instantiated(call, source, imports));
+    }
+
+    call.bytes = sizeOf(source);
+    var compiling = compiled(call, original.compile.call(wasm, source));
+    return settle(
+      call,
+      compiling.then(function (module) {
+        return instantiated(call, module, imports).then(function (instance) {
+          return { module: module, instance: instance };
+        });
+      })
+    );
+  };
+
+  if (original.compileStreaming) {
+    wasm.compileStreaming = function (source) {
+      var call = begin("compileStreaming", true, false);
+      fromResponse(call, source);
+      var module = original.compileStreaming.apply(wasm, arguments);
+      return settle(call, compiled(call, module));
+    };
+  }
+
+  if (original.instantiateStreaming && original.compileStreaming) {
+    wasm.instantiateStreaming = function (source, imports) {
+      var call = begin("instantiateStreaming", true, false);
+      fromResponse(call, source);
+      var compiling = original.compileStreaming.call(wasm, source);
+      compiling = compiled(call, compiling);
+      return settle(
+        call,
+        compiling.then(function (module) {
+          return instantiated(call, module, imports).then(function (instance) {
+            return { module: module, instance: instance };
+          });
+        })
+      );
+    };
+  }
+
+  /* Synchronous compile and instantiate block the main thread */
+  function wrapConstructor(name, field) {
+    var Original = original[name];
+    function Wrapped(arg) {
+      if (!new.target) return Original.apply(this, arguments); /* Throws */
+      var call = begin(name, false, true);
+      if (name === "Module") call.bytes = sizeOf(arg);
+      try {
+        var result = Reflect.construct(Original, arguments, new.target);
+        call[field] = now() - call.start;
+        finish(call, null);
+        return result;
+      } catch (error) {
+        finish(call, error);
+        throw error;
+      }
+    }
+    Wrapped.prototype = Original.prototype;
+    Object.setPrototypeOf(Wrapped, Original);
+    wasm[name] = Wrapped;
+  }
+  wrapConstructor("Module", "compileMs");
+  wrapConstructor("Instance", "instantiateMs");
+})();
+//# sourceURL=tauri-spy://probe/wasm.js
@@ -0,0 +1,296 @@
+/*
+ * tauri-spy probe: workers
+ *
+ * Wrap the Worker constructor and Worker.prototype.postMessage() to follow
+ * the traffic between the page and its dedicated workers. postMessage()
+ * serializes its payload before returning, so timing the call estimates the
+ * structured-clone cost at the sender. ArrayBuffers that aren't in the
+ * transfer list are copied rather than moved, and are counted apart.
+ *
+ * Replies are seen through a message listener added when the worker is
+ * created, ahead of the page's own: the gap between the event's timeStamp
+ * (when WebKit queued it) and that listener running is the time the message
+ * waited for the main thread.
+ *
+ * Strings and buffers are sized exactly, in both directions, and so are the
+ * transferred buffers. Walking every structured payload would cost the main
+ * thread as much as the clone does, so per worker and direction only one in
+ * SIZE_SAMPLE is walked (own data properties, at most SIZE_NODES values,
+ * no getters run) and the others count as the last one that was.
+ *
+ * Workers are announced as "worker_created" with their script and stack,
+ * and "worker_terminated". Once per second a "workers" record carries one row
+ * per worker that exchanged messages. Only those workers are kept in the
+ * list the flush walks; the rest are held weakly, so workers that close
+ * themselves or are dropped without terminate() can still be collected.
+ */
+(function () {
+  "use strict";
+
+  var spy = window.__tauriSpy;
+  var OriginalWorker = window.Worker;
+  if (!spy || !OriginalWorker || !spy.claim("workers")) return;
+
+  var SIZE_NODES = 10000;
+  var SIZE_SAMPLE = 16;
+  var STACK_DEPTH = 6;
+
+  var now = spy.now;
+  var proto = OriginalWorker.prototype;
+  var originalPost = proto.postMessage;
+  var originalTerminate = proto.terminate;
+
+  var states = new WeakMap(); /* Worker -> state */
+  var active = []; /* States with messages since the last flush */
+  var nextId = 0;
+  var timer = null;
+
+  function emptyCounters(state) {
+    state.sent = 0;
+    state.sentBytes = 0;
+    state.cloneMs = 0;
+    state.maxCloneMs = 0;
+    state.transferredBytes = 0;
+    state.copiedBufferBytes = 0;
+    state.received = 0;
+    state.receivedBytes = 0;
+    state.latencyMs = 0;
+    state.maxLatencyMs = 0;
+    return state;
+  }
+
+  function stateOf(worker, url) {
+    var state = states.get(worker);
+    if (!state) {
+      state = emptyCounters({
+        id: nextId++,
+        url: url || null,
+        born: now(),
+        listed: false,
+        terminated: false,
+        sendSample: { count: 0, last: null },
+        receiveSample: { count: 0, last: null },
+      });
+      states.set(worker, state);
+    }
+    return state;
+  }
+
+  /* Approximate clone size; buffers are collected to match transfers */
+  function measure(value) {
+    var result = { bytes: 0, buffers: [] };
+    var seen = new Set();
+    var queue = [value];
+    var nodes = 0;
+
+    while (queue.length && nodes++ < SIZE_NODES) {
+      var v = queue.pop();
+      if (v === null || v === undefined) continue;
+      switch (typeof v) {
+        case "string":
+          result.bytes += v.length * 2;
+          continue;
+        case "number":
+        case "bigint":
+          result.bytes += 8;
+          continue;
+        case "boolean":
+          result.bytes += 4;
+          continue;
+        case "object":
+          break;
+        default:
+          continue;
+      }
+      if (seen.has(v)) continue;
+      seen.add(v);
+
+      if (v instanceof ArrayBuffer) {
+        result.buffers.push(v);
+        result.bytes += v.byteLength;
+      } else if (ArrayBuffer.isView(v)) {
+        queue.push(v.buffer);
+      } else if (typeof Blob !== "undefined" && v instanceof Blob) {
+        /* Blobs are passed by reference */
+      } else if (v instanceof Map) {
+        v.forEach(function (value, key) {
+          queue.push(key, value);
+        });
+      } else if (v instanceof Set) {
+        v.forEach(function (value) {
+          queue.push(value);
+        });
+      } else {
+        var keys = Object.keys(v);
+        for (var i = 0; i < keys.length; i++) {
+          var d = Object.getOwnPropertyDescriptor(v, keys[i]);
+          result.bytes += keys[i].length * 2;
+          if (d && !d.get && !d.set) queue.push(d.value);
+        }
+      }
+    }
+    return result;
+  }
+
+  function transferList(options) {
+    if (Array.isArray(options)) return options;
+    if (options && Array.isArray(options.transfer)) return options.transfer;
+    return [];
+  }
+
+  function row(state) {
+    var r = [
+      state.id,
+      state.url,
+      state.sent,
+      state.sentBytes,
+      spy.round(state.cloneMs),
+      spy.round(state.maxCloneMs),
+      state.transferredBytes,
+      state.copiedBufferBytes,
+      state.received,
+      state.receivedBytes,
+      spy.round(state.latencyMs),
+      spy.round(state.maxLatencyMs),
+    ];
+    emptyCounters(state);
+    return r;
+  }
+
+  function flush() {
+    var rows = active.map(row);
+    active.forEach(function (state) {
+      state.listed = false;
+    });
+    active = [];
+    if (!rows.length) {
+      spy.clearInterval(timer);
+      timer = null;
+      return;
+    }
+    spy.emit("workers", { items: rows });
+  }
+
+  function touched(state) {
+    if (!state.listed) {
+      state.listed = true;
+      active.push(state);
+    }
+    if (!timer) timer = spy.setInterval(flush, 1000);
+  }
+
+  function bufferOf(value) {
+    if (value instanceof ArrayBuffer) return value;
+    return ArrayBuffer.isView(value) ? value.buffer : null;
+  }
+
+  /*
+   * { bytes, copied } for one payload, copied being the bytes of buffers
+   * cloned rather than transferred. Must run before a send detaches them.
+   */
+  function sized(sample, value, transfer) {
+    if (typeof value === "string") {
+      return { bytes: value.length * 2, copied: 0 };
+    }
+    var buffer = bufferOf(value);
+    if (buffer) {
+      var copied = transfer.indexOf(buffer) >= 0 ? 0 : buffer.byteLength;
+      return { bytes: value.byteLength, copied: copied };
+    }
+    if (value === null || typeof value !== "object") {
+      return { bytes: 8, copied: 0 };
+    }
+    if (sample.count++ % SIZE_SAMPLE === 0) {
+      var size = measure(value);
+      var last = { bytes: size.bytes, copied: 0 };
+      size.buffers.forEach(function (b) {
+        if (transfer.indexOf(b) < 0) last.copied += b.byteLength;
+      });
+      sample.last = last;
+    }
+    return sample.last;
+  }
+
+  function transferredBytes(transfer) {
+    var bytes = 0;
+    for (var i = 0; i < transfer.length; i++) {
+      if (transfer[i] instanceof ArrayBuffer) bytes += transfer[i].byteLength;
+    }
+    return bytes;
+  }
+
+  function onMessage(event) {
+    var state = states.get(this);
+    if (!state) return;
+    var latency = now() - event.timeStamp;
+    state.received++;
+    state.receivedBytes += sized(state.receiveSample, event.data, []).bytes;
+    /* Older WebKit stamps events with epoch time; skip those */
+    if (latency >= 0 && latency < 60000) {
+      state.latencyMs += latency;
+      if (latency > state.maxLatencyMs) state.maxLatencyMs = latency;
+    }
+    touched(state);
+  }
+
+  function Worker(url) {
+    var worker = Reflect.construct(
+      OriginalWorker,
+      arguments,
+      new.target || OriginalWorker
+    );
+    var state = stateOf(worker, String(url));
+    var stack = spy.stack(STACK_DEPTH);
+    worker.addEventListener("message", onMessage);
+    spy.emit("worker_created", {
+      worker: state.id,
+      url: state.url,
+      site: stack[0] || null,
+      stack: stack,
+    });
+    return worker;
+  }
+  Worker.prototype = proto;
+  Object.setPrototypeOf(Worker, OriginalWorker);
+  window.Worker = Worker;
+
+  proto.postMessage = function (message, options) {
+    var state = stateOf(this);
+    var transfer = transferList(options);
+    /* Transferred buffers are detached by the time the call returns */
+    var size = sized(state.sendSample, message, transfer);
+    var moved = transferredBytes(transfer);
+
+    var start = now();
+    try {
+      return originalPost.apply(this, arguments);
+    } finally {
+      var ms = now() - start;
+      state.sent++;
+      state.sentBytes += size.bytes;
+      state.cloneMs += ms;
+      if (ms > state.maxCloneMs) state.maxCloneMs = ms;
+      state.transferredBytes += moved;
+      state.copiedBufferBytes += size.copied;
+      touched(state);
+    }
+  };
+
+  proto.terminate = function () {
+    var state = states.get(this);
+    if (state && !state.terminated) {
+      state.terminated = true;
+      if (state.listed) {
+        state.listed = false;
+        active.splice(active.indexOf(state), 1);
+        spy.emit("workers", { items: [row(state)] });
+      }
+      spy.emit("worker_terminated", {
+        worker: state.id,
+        lifetime_ms: Math.round(now() - state.born),
+      });
+    }
+    return originalTerminate.apply(this, arguments);
+  };
+})();
+//# sourceURL=tauri-spy://probe/workers.js
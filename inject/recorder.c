@@ -0,0 +1,152 @@
+/*
+ * recorder.c — JSON-lines report sink for libspy telemetry
+ *
+ * Native hooks and page probes both end up here. The report path comes from
+ * TAURI_SPY_REPORT (set by `tauri-spy --report`); without it every record is
+ * dropped before it is formatted, so instrumented hot paths stay cheap.
+ *
+ * The file is opened lazily on first use: LD_PRELOAD is inherited by the
+ * WebKit helper processes, and only the UI process ever records anything.
+ */
+
+#define _GNU_SOURCE
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "spy.h"
+
+static GMutex recorder_lock;
+static FILE *report_file = NULL;
+static gint64 recorder_epoch = 0;
+static gsize recorder_ready = 0;
+
+static void recorder_init(void) {
+  if (!g_once_init_enter(&recorder_ready))
+    return;
+
+  recorder_epoch = g_get_monotonic_time();
+
+  const char *path = getenv("TAURI_SPY_REPORT");
+  if (path && *path) {
+    report_file = fopen(path, "w");
+    if (report_file) {
+      atexit(spy_recorder_flush);
+      fprintf(stderr, "[tauri-spy] Recording telemetry to %s\n", path);
+    } else {
+      fprintf(stderr, "[tauri-spy] WARNING: Could not open report file %s\n",
+              path);
+    }
+  }
+
+  g_once_init_leave(&recorder_ready, 1);
+}
+
+int spy_recorder_active(void) {
+  recorder_init();
+  return report_file != NULL;
+}
+
+/*
+ * Microseconds since the recorder opened — the "ts" of every record.
+ */
+gint64 spy_now_us(void) {
+  recorder_init();
+  return g_get_monotonic_time() - recorder_epoch;
+}
+
+/*
+ * Write one native record. fields_fmt expands to the record's own JSON
+ * members without the surrounding braces, e.g. "\"calls\":%d".
+ */
+void spy_record(int webview, const char *kind, const char *fields_fmt, ...) {
+  if (!spy_recorder_active())
+    return;
+
+  gint64 ts = spy_now_us();
+
+  g_mutex_lock(&recorder_lock);
+  fprintf(report_file,
+          "{\"ts\":%" G_GINT64_FORMAT ",\"webview\":%d,\"kind\":\"%s\"", ts,
+          webview, kind);
+  if (fields_fmt && *fields_fmt) {
+    va_list ap;
+    va_start(ap, fields_fmt);
+    fputc(',', report_file);
+    vfprintf(report_file, fields_fmt, ap);
+    va_end(ap);
+  }
+  fputs("}\n", report_file);
+  fflush(report_file);
+  g_mutex_unlock(&recorder_lock);
+}
+
+/*
+ * Write one record produced by a page probe. json_object is a complete JSON
+ * object (it already carries "kind"); the recorder only splices "ts" and
+ * "webview" in front of its first member. Call spy_recorder_flush() once the
+ * whole batch has been written.
+ */
+void spy_record_page(int webview, const char *json_object, gsize length) {
+  if (length < 2 || json_object[0] != '{' || json_object[length - 1] != '}')
+    return;
+  if (!spy_recorder_active())
+    return;
+
+  gint64 ts = spy_now_us();
+
+  g_mutex_lock(&recorder_lock);
+  fprintf(report_file, "{\"ts\":%" G_GINT64_FORMAT ",\"webview\":%d%s", ts,
+          webview, length > 2 ? "," : "");
+  fwrite(json_object + 1, 1, length - 1, report_file);
+  fputc('\n', report_file);
+  g_mutex_unlock(&recorder_lock);
+}
+
+void spy_recorder_flush(void) {
+  if (!report_file)
+    return;
+
+  g_mutex_lock(&recorder_lock);
+  fflush(report_file);
+  g_mutex_unlock(&recorder_lock);
+}
+
+/*
+ * Quote and escape a C string for use as a JSON value. Returns a newly
+ * allocated string ("null" for NULL); free it with g_free().
+ */
+char *spy_json_string(const char *str) {
+  if (!str)
+    return g_strdup("null");
+
+  GString *out = g_string_sized_new(strlen(str) + 2);
+  g_string_append_c(out, '"');
+  for (const unsigned char *p = (const unsigned char *)str; *p; p++) {
+    switch (*p) {
+    case '"':
+      g_string_append(out, "\\\"");
+      break;
+    case '\\':
+      g_string_append(out, "\\\\");
+      break;
+    case '\n':
+      g_string_append(out, "\\n");
+      break;
+    case '\r':
+      g_string_append(out, "\\r");
+      break;
+    case '\t':
+      g_string_append(out, "\\t");
+      break;
+    default:
+      if (*p < 0x20)
+        g_string_append_printf(out, "\\u%04x", *p);
+      else
+        g_string_append_c(out, (gchar)*p);
+    }
+  }
+  g_string_append_c(out, '"');
+  return g_string_free(out, FALSE);
+}
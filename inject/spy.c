@@ -10,7 +10,10 @@
  *   - webkit_settings_set_enable_developer_extras() to prevent the target
  *     app from disabling DevTools after we enable them.
  *
- * Also installs a Ctrl+Shift+I keyboard handler for toggling the inspector.
+ * Also installs a Ctrl+Shift+I keyboard handler for toggling the inspector,
+ * attaches the page metrics channel (channel.c) to every webview found,
+ * watches each toplevel for rendering while hidden (windows.c) and starts
+ * the main-loop wakeup auditor (wakeups.c) when those were selected.
  */
 
 #define _GNU_SOURCE
@@ -23,6 +26,8 @@
 #include <gtk/gtk.h>
 #include <webkit2/webkit2.h>
 
+#include "spy.h"
+
 static int spy_enabled = 0;
 static int idle_installed = 0;
 static int auto_open = 0;
@@ -99,6 +104,8 @@ static void enable_devtools_on_webview(WebKitWebView *view) {
     discovered_webviews[webview_count++] = view;
   }
 
+  spy_channel_attach(view);
+
   if (auto_open) {
     WebKitWebInspector *inspector = webkit_web_view_get_inspector(view);
     if (inspector) {
@@ -230,6 +237,9 @@ static gboolean idle_callback(gpointer data) {
     if (!win)
       continue;
 
+    if (GTK_IS_WINDOW(win))
+      spy_windows_watch(GTK_WINDOW(win));
+
     /* Avoid duplicate handlers using GObject data */
     if (!g_object_get_data(G_OBJECT(win), "tauri-spy-key-handler")) {
       g_signal_connect(win, "key-press-event", G_CALLBACK(on_key_press), NULL);
@@ -261,6 +271,7 @@ static void install_idle_callback(void) {
   }
 
   g_idle_add(idle_callback, NULL);
+  spy_wakeups_install();
 }
 
 /*
@@ -329,5 +340,10 @@ gboolean gtk_main_iteration_do(gboolean blocking) {
     install_idle_callback();
   }
 
-  return real_gtk_main_iteration_do(blocking);
+  /* Lets wakeups.c tell blocking iterations from busy-polling ones */
+  int previous = spy_wakeups_enter_iteration(blocking);
+  gboolean quit = real_gtk_main_iteration_do(blocking);
+  spy_wakeups_leave_iteration(previous);
+  spy_windows_tick();
+  return quit;
 }
@@ -0,0 +1,75 @@
+/*
+ * spy.h — shared declarations for the libspy.so translation units
+ *
+ * libspy is built from every C file in inject/. spy.c owns the DevTools
+ * injection; the other units add telemetry on top of it and talk to each
+ * other only through the functions declared here.
+ */
+
+#ifndef TAURI_SPY_H
+#define TAURI_SPY_H
+
+#include <gtk/gtk.h>
+#include <webkit2/webkit2.h>
+
+/* Embedded page probe (generated from inject/probes by build.rs) */
+struct spy_probe_source {
+  const char *name;
+  const char *source;
+};
+
+/*
+ * recorder.c — append-only JSON-lines report written to $TAURI_SPY_REPORT.
+ *
+ * Every line is one JSON object carrying "ts" (microseconds since the
+ * recorder opened), "webview" (the id from spy_webview_id(), or -1 for
+ * process-wide records) and "kind". All functions are no-ops when no report
+ * file was requested.
+ */
+int spy_recorder_active(void);
+gint64 spy_now_us(void);
+void spy_record(int webview, const char *kind, const char *fields_fmt, ...)
+    G_GNUC_PRINTF(3, 4);
+void spy_record_page(int webview, const char *json_object, gsize length);
+void spy_recorder_flush(void);
+char *spy_json_string(const char *str);
+
+/*
+ * channel.c — page-to-libspy metrics channel and probe selection.
+ */
+int spy_webview_id(WebKitWebView *view);
+int spy_probe_enabled(const char *name);
+void spy_channel_install(WebKitUserContentManager *manager);
+void spy_channel_attach(WebKitWebView *view);
+
+/*
+ * console.c — console output files (the "console" probe).
+ */
+void spy_console_install(WebKitUserContentManager *manager);
+
+/*
+ * evaluate.c — tracing of webkit_web_view_evaluate_javascript() traffic.
+ */
+void spy_evaluate_javascript_untraced(WebKitWebView *view, const char *script);
+
+/*
+ * userscripts.c — init-script size and timing accounting.
+ */
+void spy_add_user_script_untraced(WebKitUserContentManager *manager,
+                                  const char *source);
+
+/*
+ * wakeups.c — main-loop wakeup auditing (the "wakeups" probe).
+ */
+void spy_wakeups_install(void);
+int spy_wakeups_enter_iteration(gboolean blocking);
+void spy_wakeups_leave_iteration(int previous);
+
+/*
+ * windows.c — rendering in hidden windows (the "hidden-windows" probe).
+ */
+void spy_windows_watch(GtkWindow *window);
+void spy_windows_track(WebKitWebView *view);
+void spy_windows_tick(void);
+
+#endif /* TAURI_SPY_H */
@@ -0,0 +1,221 @@
+/*
+ * userscripts.c — init-script cost accounting
+ *
+ * Tauri, wry and plugins register their initialization scripts on the
+ * webview's WebKitUserContentManager; WebKit re-runs every one of them on
+ * each navigation. WebKitUserScript is opaque once built, so sizes are
+ * captured when the script is created and tallied when it is registered.
+ * A created script is held (with a reference, so its address cannot be
+ * reused) only until its first registration; adding the same script to a
+ * second content manager passes it through untraced.
+ *
+ * To time the scripts in the page, each registered main-world script is
+ * bracketed by two one-line marker scripts that push performance.now() into
+ * window.__tauriSpyInit; probes/init-scripts.js turns those into per-script
+ * evaluation times for every navigation. That probe runs in the top frame
+ * only, so markers do too: a script injected into all frames is timed as it
+ * runs in the top frame.
+ *
+ * Hooks:
+ *   - webkit_user_script_new() / webkit_user_script_new_for_world()
+ *   - webkit_user_content_manager_add_script()
+ */
+
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "spy.h"
+
+/* What we know about a script created through the hooks below */
+struct script_info {
+  gsize bytes;
+  WebKitUserContentInjectedFrames frames;
+  WebKitUserScriptInjectionTime time;
+  int main_world;
+};
+
+static GHashTable *created_scripts = NULL;
+static int next_script_id = 0;
+
+/* Real function pointers — resolved via dlsym */
+typedef WebKitUserScript *(*user_script_new_fn)(
+    const gchar *, WebKitUserContentInjectedFrames,
+    WebKitUserScriptInjectionTime, const gchar *const *, const gchar *const *);
+static user_script_new_fn real_user_script_new = NULL;
+
+typedef WebKitUserScript *(*user_script_new_for_world_fn)(
+    const gchar *, WebKitUserContentInjectedFrames,
+    WebKitUserScriptInjectionTime, const gchar *, const gchar *const *,
+    const gchar *const *);
+static user_script_new_for_world_fn real_user_script_new_for_world = NULL;
+
+typedef void (*add_script_fn)(WebKitUserContentManager *, WebKitUserScript *);
+static add_script_fn real_add_script = NULL;
+
+static void ensure_real_user_script_new(void) {
+  if (!real_user_script_new) {
+    real_user_script_new =
+        (user_script_new_fn)dlsym(RTLD_NEXT, "webkit_user_script_new");
+  }
+}
+
+static void ensure_real_add_script(void) {
+  if (!real_add_script) {
+    real_add_script = (add_script_fn)dlsym(
+        RTLD_NEXT, "webkit_user_content_manager_add_script");
+  }
+}
+
+static void remember_script(WebKitUserScript *script, const gchar *source,
+                            WebKitUserContentInjectedFrames frames,
+                            WebKitUserScriptInjectionTime time,
+                            int main_world) {
+  if (!script || !source || !spy_recorder_active())
+    return;
+
+  if (!created_scripts)
+    created_scripts = g_hash_table_new_full(
+        g_direct_hash, g_direct_equal,
+        (GDestroyNotify)webkit_user_script_unref, g_free);
+
+  struct script_info *info = g_new0(struct script_info, 1);
+  info->bytes = strlen(source);
+  info->frames = frames;
+  info->time = time;
+  info->main_world = main_world;
+  g_hash_table_replace(created_scripts, webkit_user_script_ref(script), info);
+}
+
+/*
+ * Register a marker script next to a traced one. phase is 0 before the
+ * traced script and 1 after it. Each marker pushes
+ * [id, phase, bytes, at_document_end, performance.now()], in the top frame
+ * where probes/init-scripts.js reads it.
+ */
+static void add_marker(WebKitUserContentManager *manager, int id, int phase,
+                       const struct script_info *info) {
+  char *source = g_strdup_printf(
+      "(self.__tauriSpyInit=self.__tauriSpyInit||[])"
+      ".push([%d,%d,%" G_GSIZE_FORMAT ",%d,performance.now()]);",
+      id, phase, info->bytes,
+      info->time == WEBKIT_USER_SCRIPT_INJECT_AT_DOCUMENT_END);
+  WebKitUserScript *marker =
+      real_user_script_new(source, WEBKIT_USER_CONTENT_INJECT_TOP_FRAME,
+                           info->time, NULL, NULL);
+  real_add_script(manager, marker);
+  webkit_user_script_unref(marker);
+  g_free(source);
+}
+
+/*
+ * Register one of libspy's own scripts without accounting or markers.
+ */
+void spy_add_user_script_untraced(WebKitUserContentManager *manager,
+                                  const char *source) {
+  ensure_real_user_script_new();
+  ensure_real_add_script();
+  if (!real_user_script_new || !real_add_script)
+    return;
+
+  WebKitUserScript *script = real_user_script_new(
+      source, WEBKIT_USER_CONTENT_INJECT_TOP_FRAME,
+      WEBKIT_USER_SCRIPT_INJECT_AT_DOCUMENT_START, NULL, NULL);
+  real_add_script(manager, script);
+  webkit_user_script_unref(script);
+}
+
+/*
+ * Hook: webkit_user_script_new()
+ */
+WebKitUserScript *
+webkit_user_script_new(const gchar *source,
+                       WebKitUserContentInjectedFrames injected_frames,
+                       WebKitUserScriptInjectionTime injection_time,
+                       const gchar *const *allow_list,
+                       const gchar *const *block_list) {
+  ensure_real_user_script_new();
+  if (!real_user_script_new) {
+    fprintf(stderr,
+            "[tauri-spy] FATAL: Could not find real webkit_user_script_new()\n");
+    return NULL;
+  }
+
+  WebKitUserScript *script = real_user_script_new(
+      source, injected_frames, injection_time, allow_list, block_list);
+  remember_script(script, source, injected_frames, injection_time, 1);
+  return script;
+}
+
+/*
+ * Hook: webkit_user_script_new_for_world() — sized, but not timed: markers
+ * would land in the other world's global object where no probe can see them.
+ */
+WebKitUserScript *webkit_user_script_new_for_world(
+    const gchar *source, WebKitUserContentInjectedFrames injected_frames,
+    WebKitUserScriptInjectionTime injection_time, const gchar *world_name,
+    const gchar *const *allow_list, const gchar *const *block_list) {
+  if (!real_user_script_new_for_world) {
+    real_user_script_new_for_world = (user_script_new_for_world_fn)dlsym(
+        RTLD_NEXT, "webkit_user_script_new_for_world");
+    if (!real_user_script_new_for_world) {
+      fprintf(stderr, "[tauri-spy] FATAL: Could not find real "
+                      "webkit_user_script_new_for_world()\n");
+      return NULL;
+    }
+  }
+
+  WebKitUserScript *script = real_user_script_new_for_world(
+      source, injected_frames, injection_time, world_name, allow_list,
+      block_list);
+  remember_script(script, source, injected_frames, injection_time, 0);
+  return script;
+}
+
+/*
+ * Hook: webkit_user_content_manager_add_script()
+ */
+void webkit_user_content_manager_add_script(WebKitUserContentManager *manager,
+                                            WebKitUserScript *script) {
+  ensure_real_add_script();
+  if (!real_add_script) {
+    fprintf(stderr, "[tauri-spy] FATAL: Could not find real "
+                    "webkit_user_content_manager_add_script()\n");
+    return;
+  }
+
+  /* Our probes go first so they can wrap globals before the app's scripts */
+  spy_channel_install(manager);
+
+  gpointer key = NULL;
+  gpointer value = NULL;
+  if (!created_scripts || !g_hash_table_steal_extended(created_scripts, script,
+                                                       &key, &value)) {
+    real_add_script(manager, script);
+    return;
+  }
+  struct script_info *info = value;
+
+  int id = next_script_id++;
+  spy_record(-1, "user_script",
+             "\"id\":%d,\"manager\":\"%p\",\"bytes\":%" G_GSIZE_FORMAT
+             ",\"frames\":\"%s\",\"injection\":\"%s\",\"main_world\":%s",
+             id, (void *)manager, info->bytes,
+             info->frames == WEBKIT_USER_CONTENT_INJECT_ALL_FRAMES ? "all"
+                                                                   : "top",
+             info->time == WEBKIT_USER_SCRIPT_INJECT_AT_DOCUMENT_START
+                 ? "start"
+                 : "end",
+             info->main_world ? "true" : "false");
+
+  if (info->main_world)
+    add_marker(manager, id, 0, info);
+  real_add_script(manager, script);
+  if (info->main_world)
+    add_marker(manager, id, 1, info);
+
+  g_free(info);
+  webkit_user_script_unref(key);
+}
@@ -0,0 +1,257 @@
+/*
+ * wakeups.c — main-loop wakeup auditor (opt-in "wakeups" probe)
+ *
+ * Every wakeup of the GTK main thread goes through the default main
+ * context's poll function. Wrapping it tells why each wait ended:
+ *
+ *   - fd      a file descriptor became ready (X/Wayland, D-Bus, WebKit IPC)
+ *   - timer   the wait timed out, i.e. a GLib timeout source was due
+ *   - ready   a source was already pending (idles), so the poll didn't wait
+ *   - spin    a non-blocking gtk_main_iteration_do(FALSE) iteration found
+ *             nothing to do; tao's event loop busy-polls this way
+ *
+ * A non-blocking iteration polls without waiting whether or not a source is
+ * ready, so its polls are classified only once the iteration is over: as
+ * ready if it dispatched anything, as spin if not. Whether it did is what
+ * g_main_context_iteration() returns; gtk_main_iteration_do() doesn't pass
+ * that on, so it is hooked here.
+ *
+ * Counts, time spent waiting, main-thread and process CPU time and the
+ * busiest descriptors go to a "wakeups" record roughly once per second. The
+ * record is written from the poll function after a wakeup, so auditing adds
+ * no timer of its own.
+ */
+
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "spy.h"
+
+/* Descriptors counted individually; higher ones are lumped together */
+#define MAX_TRACKED_FDS 1024
+
+/* Descriptors named in each record */
+#define TOP_FDS 5
+
+enum { ITERATION_NONE = -1, ITERATION_NONBLOCKING = 0, ITERATION_BLOCKING = 1 };
+
+struct wakeup_stats {
+  guint polls;
+  guint timer;
+  guint fd;
+  guint ready;
+  guint spin;
+  guint interrupted;
+  guint blocking_iterations;
+  guint nonblocking_iterations;
+  gint64 sleep_us;
+  guint fd_hits[MAX_TRACKED_FDS];
+  guint other_fd_hits;
+};
+
+static struct wakeup_stats stats;
+static GPollFunc real_poll = NULL;
+static int installed = 0;
+static int iteration_mode = ITERATION_NONE;
+
+/* Zero-timeout polls of the current non-blocking iteration, unclassified */
+static guint pending_polls = 0;
+static gboolean iteration_dispatched = FALSE;
+
+typedef gboolean (*context_iteration_fn)(GMainContext *, gboolean);
+static context_iteration_fn real_context_iteration = NULL;
+
+static gint64 window_start_us = 0;
+static gint64 main_cpu_start_us = 0;
+static gint64 process_cpu_start_us = 0;
+
+static gint64 cpu_time_us(int who) {
+  struct rusage usage;
+  if (getrusage(who, &usage) != 0)
+    return 0;
+  return (gint64)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) *
+             G_USEC_PER_SEC +
+         usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+/* What /proc says the descriptor is: socket:[...], pipe:[...], a path */
+static char *fd_label(int fd) {
+  char link[64];
+  char target[256];
+  snprintf(link, sizeof(link), "/proc/self/fd/%d", fd);
+  ssize_t length = readlink(link, target, sizeof(target) - 1);
+  if (length < 0)
+    return spy_json_string("?");
+  target[length] = '\0';
+  return spy_json_string(target);
+}
+
+/* JSON array of [fd, wakeups, label] for the busiest descriptors */
+static char *top_fds_json(void) {
+  GString *out = g_string_new("[");
+  guint taken[TOP_FDS];
+  int count = 0;
+
+  for (int n = 0; n < TOP_FDS; n++) {
+    int best = -1;
+    for (int fd = 0; fd < MAX_TRACKED_FDS; fd++) {
+      if (!stats.fd_hits[fd])
+        continue;
+      int used = 0;
+      for (int i = 0; i < count; i++)
+        used |= taken[i] == (guint)fd;
+      if (!used && (best < 0 || stats.fd_hits[fd] > stats.fd_hits[best]))
+        best = fd;
+    }
+    if (best < 0)
+      break;
+    taken[count++] = best;
+
+    char *label = fd_label(best);
+    g_string_append_printf(out, "%s[%d,%u,%s]", n ? "," : "", best,
+                           stats.fd_hits[best], label);
+    g_free(label);
+  }
+
+  g_string_append_c(out, ']');
+  return g_string_free(out, FALSE);
+}
+
+static void flush(gint64 now_us) {
+  gint64 main_cpu_us = cpu_time_us(RUSAGE_THREAD);
+  gint64 process_cpu_us = cpu_time_us(RUSAGE_SELF);
+  char *fds = top_fds_json();
+
+  spy_record(-1, "wakeups",
+             "\"span_us\":%" G_GINT64_FORMAT ",\"polls\":%u,\"timer\":%u,"
+             "\"fd\":%u,\"ready\":%u,\"spin\":%u,\"interrupted\":%u,"
+             "\"blocking_iterations\":%u,\"nonblocking_iterations\":%u,"
+             "\"sleep_us\":%" G_GINT64_FORMAT
+             ",\"main_cpu_us\":%" G_GINT64_FORMAT
+             ",\"process_cpu_us\":%" G_GINT64_FORMAT
+             ",\"other_fd\":%u,\"fds\":%s",
+             now_us - window_start_us, stats.polls, stats.timer, stats.fd,
+             stats.ready, stats.spin, stats.interrupted,
+             stats.blocking_iterations, stats.nonblocking_iterations,
+             stats.sleep_us, main_cpu_us - main_cpu_start_us,
+             process_cpu_us - process_cpu_start_us, stats.other_fd_hits, fds);
+  g_free(fds);
+
+  memset(&stats, 0, sizeof(stats));
+  window_start_us = now_us;
+  main_cpu_start_us = main_cpu_us;
+  process_cpu_start_us = process_cpu_us;
+}
+
+static gint audited_poll(GPollFD *fds, guint nfds, gint timeout) {
+  gint64 start_us = spy_now_us();
+  gint ready = real_poll(fds, nfds, timeout);
+  gint64 end_us = spy_now_us();
+
+  stats.polls++;
+  stats.sleep_us += end_us - start_us;
+
+  if (ready > 0) {
+    stats.fd++;
+    for (guint i = 0; i < nfds; i++) {
+      if (!fds[i].revents)
+        continue;
+      if (fds[i].fd >= 0 && fds[i].fd < MAX_TRACKED_FDS)
+        stats.fd_hits[fds[i].fd]++;
+      else
+        stats.other_fd_hits++;
+    }
+  } else if (ready < 0) {
+    stats.interrupted++;
+  } else if (timeout != 0) {
+    stats.timer++;
+  } else if (iteration_mode == ITERATION_NONBLOCKING) {
+    pending_polls++;
+  } else {
+    stats.ready++;
+  }
+
+  if (end_us - window_start_us >= G_USEC_PER_SEC)
+    flush(end_us);
+  return ready;
+}
+
+/*
+ * Wrap the default main context's poll function, if the "wakeups" probe was
+ * selected. Called from spy.c's main-loop hooks; installs once.
+ */
+void spy_wakeups_install(void) {
+  if (installed)
+    return;
+  installed = 1;
+
+  if (!spy_recorder_active() || !spy_probe_enabled("wakeups"))
+    return;
+
+  GMainContext *context = g_main_context_default();
+  real_poll = g_main_context_get_poll_func(context);
+  if (!real_poll) {
+    fprintf(stderr, "[tauri-spy] WARNING: No main-loop poll function to "
+                    "audit\n");
+    return;
+  }
+
+  window_start_us = spy_now_us();
+  main_cpu_start_us = cpu_time_us(RUSAGE_THREAD);
+  process_cpu_start_us = cpu_time_us(RUSAGE_SELF);
+  g_main_context_set_poll_func(context, audited_poll);
+  fprintf(stderr, "[tauri-spy] Auditing main-loop wakeups\n");
+}
+
+/*
+ * Bracket one gtk_main_iteration_do() call so polls inside it know whether
+ * the iteration was allowed to block. Returns the mode to restore.
+ */
+int spy_wakeups_enter_iteration(gboolean blocking) {
+  int previous = iteration_mode;
+  iteration_dispatched = FALSE;
+  if (blocking)
+    stats.blocking_iterations++;
+  else
+    stats.nonblocking_iterations++;
+  iteration_mode = blocking ? ITERATION_BLOCKING : ITERATION_NONBLOCKING;
+  return previous;
+}
+
+void spy_wakeups_leave_iteration(int previous) {
+  if (iteration_mode == ITERATION_NONBLOCKING) {
+    if (iteration_dispatched)
+      stats.ready += pending_polls;
+    else
+      stats.spin += pending_polls;
+    pending_polls = 0;
+  }
+  iteration_mode = previous;
+}
+
+/*
+ * Hook: g_main_context_iteration() — gtk_main_iteration_do() runs one
+ * iteration of the default context through this; note whether it
+ * dispatched a source.
+ */
+gboolean g_main_context_iteration(GMainContext *context, gboolean may_block) {
+  if (!real_context_iteration) {
+    real_context_iteration = (context_iteration_fn)dlsym(
+        RTLD_NEXT, "g_main_context_iteration");
+    if (!real_context_iteration) {
+      fprintf(stderr, "[tauri-spy] FATAL: Could not find real "
+                      "g_main_context_iteration()\n");
+      return FALSE;
+    }
+  }
+
+  gboolean dispatched = real_context_iteration(context, may_block);
+  if (dispatched && iteration_mode != ITERATION_NONE)
+    iteration_dispatched = TRUE;
+  return dispatched;
+}
@@ -0,0 +1,352 @@
+/*
+ * windows.c — rendering in hidden windows (opt-in "hidden-windows" probe)
+ *
+ * Tray-resident apps often keep painting after their window is minimized or
+ * covered. For every toplevel holding a webview — found by spy.c at startup,
+ * or later when a webview lands in a new window — follow its map state,
+ * window state (minimized, withdrawn, focused) and X11 visibility (fully
+ * obscured), and count the frames its frame clock paints.
+ *
+ * State changes are recorded as "window_state". A "window_activity" record
+ * per hidden window carries, over span_us, the frames it still painted and
+ * its share of the process CPU time and, where the kernel exposes RAPL to
+ * this user, of the CPU package energy: both are split evenly across the
+ * windows hidden at the time. Every state change ends the current span, so
+ * a window is either hidden or visible for the whole of one; otherwise a
+ * span ends after a second, checked from the main-loop iterations and
+ * frames that happen anyway, so watching adds no wakeup of its own. The
+ * page side of the probe (probes/hidden-windows.js) counts
+ * requestAnimationFrame callbacks so the report can line both up.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include "spy.h"
+
+/* CPU package energy counter, microjoules; machine-wide */
+#define RAPL_ENERGY_PATH "/sys/class/powercap/intel-rapl:0/energy_uj"
+
+struct window_watch {
+  int id;
+  char *webviews; /* JSON array of webview ids */
+  gboolean mapped;
+  gboolean obscured;
+  GdkWindowState state;
+  guint frames; /* Painted while hidden, since the last flush */
+};
+
+static GList *watches = NULL;
+static int next_window_id = 0;
+static gint64 last_flush_us = -1;
+static gint64 last_cpu_us = -1;
+static gint64 last_energy_uj = -1;
+
+static gint64 process_cpu_us(void) {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+  return (gint64)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) *
+             G_USEC_PER_SEC +
+         usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+/* -1 when RAPL is missing or root-only */
+static gint64 package_energy_uj(void) {
+  FILE *f = fopen(RAPL_ENERGY_PATH, "r");
+  if (!f)
+    return -1;
+  long long energy = -1;
+  if (fscanf(f, "%lld", &energy) != 1)
+    energy = -1;
+  fclose(f);
+  return energy;
+}
+
+static gboolean is_hidden(const struct window_watch *w) {
+  return !w->mapped || w->obscured ||
+         (w->state & (GDK_WINDOW_STATE_ICONIFIED | GDK_WINDOW_STATE_WITHDRAWN));
+}
+
+static void record_state(struct window_watch *w) {
+  spy_record(-1, "window_state",
+             "\"window\":%d,\"webviews\":%s,\"hidden\":%s,\"mapped\":%s,"
+             "\"minimized\":%s,\"obscured\":%s,\"focused\":%s",
+             w->id, w->webviews, is_hidden(w) ? "true" : "false",
+             w->mapped ? "true" : "false",
+             (w->state & GDK_WINDOW_STATE_ICONIFIED) ? "true" : "false",
+             w->obscured ? "true" : "false",
+             (w->state & GDK_WINDOW_STATE_FOCUSED) ? "true" : "false");
+}
+
+static void flush(gint64 now_us) {
+  gint64 cpu_us = process_cpu_us();
+  gint64 energy_uj = package_energy_uj();
+  gint64 cpu_delta = last_cpu_us < 0 ? 0 : cpu_us - last_cpu_us;
+  /* Negative across a counter wrap-around; that second goes without */
+  gint64 energy_delta = (energy_uj < 0 || last_energy_uj < 0)
+                            ? -1
+                            : energy_uj - last_energy_uj;
+  gint64 span_us = now_us - last_flush_us;
+  last_cpu_us = cpu_us;
+  last_energy_uj = energy_uj;
+  last_flush_us = now_us;
+
+  /* Process-wide counters: each hidden window gets an equal share */
+  gint64 hidden = 0;
+  for (GList *l = watches; l != NULL; l = l->next)
+    hidden += is_hidden(l->data);
+
+  for (GList *l = watches; l != NULL; l = l->next) {
+    struct window_watch *w = l->data;
+    if (is_hidden(w)) {
+      char *energy =
+          energy_delta >= 0
+              ? g_strdup_printf(",\"energy_uj\":%" G_GINT64_FORMAT,
+                                energy_delta / hidden)
+              : g_strdup("");
+      spy_record(-1, "window_activity",
+                 "\"window\":%d,\"webviews\":%s,\"span_us\":%" G_GINT64_FORMAT
+                 ",\"frames\":%u,\"cpu_us\":%" G_GINT64_FORMAT
+                 ",\"hidden_windows\":%" G_GINT64_FORMAT "%s",
+                 w->id, w->webviews, span_us, w->frames, cpu_delta / hidden,
+                 hidden, energy);
+      g_free(energy);
+    }
+    w->frames = 0;
+  }
+}
+
+/*
+ * End the current span before a window's state changes, so the span is
+ * charged to the state it was spent in.
+ */
+static void flush_before_change(void) {
+  gint64 now_us = spy_now_us();
+  if (now_us > last_flush_us)
+    flush(now_us);
+}
+
+/*
+ * Flush if a second has passed. Called from spy.c's main-loop hook and from
+ * the signal handlers below rather than from a timeout source, which would
+ * wake an idle app up once a second and show up in the wakeups probe.
+ */
+void spy_windows_tick(void) {
+  if (!watches)
+    return;
+  gint64 now_us = spy_now_us();
+  if (now_us - last_flush_us >= G_USEC_PER_SEC)
+    flush(now_us);
+}
+
+/*
+ * Signal: window-state-event — minimized, withdrawn, focus changes.
+ */
+static gboolean on_window_state(GtkWidget *widget, GdkEventWindowState *event,
+                                gpointer data) {
+  (void)widget;
+  struct window_watch *w = data;
+  flush_before_change();
+  w->state = event->new_window_state;
+  record_state(w);
+  return FALSE;
+}
+
+/*
+ * Signals: map-event / unmap-event.
+ */
+static gboolean on_map_changed(GtkWidget *widget, GdkEventAny *event,
+                               gpointer data) {
+  (void)event;
+  struct window_watch *w = data;
+  flush_before_change();
+  w->mapped = gtk_widget_get_mapped(widget);
+  record_state(w);
+  return FALSE;
+}
+
+/*
+ * Signal: visibility-notify-event — X11 only; Wayland never reports
+ * occlusion.
+ */
+static gboolean on_visibility(GtkWidget *widget, GdkEventVisibility *event,
+                              gpointer data) {
+  (void)widget;
+  struct window_watch *w = data;
+  gboolean obscured = event->state == GDK_VISIBILITY_FULLY_OBSCURED;
+  if (obscured != w->obscured) {
+    flush_before_change();
+    w->obscured = obscured;
+    record_state(w);
+  }
+  return FALSE;
+}
+
+/*
+ * Signal: GdkFrameClock::after-paint — one painted frame.
+ */
+static void on_after_paint(GdkFrameClock *clock, gpointer data) {
+  (void)clock;
+  struct window_watch *w = data;
+  if (is_hidden(w))
+    w->frames++;
+  spy_windows_tick();
+}
+
+static void connect_frame_clock(GtkWidget *window, struct window_watch *w) {
+  GdkFrameClock *clock = gtk_widget_get_frame_clock(window);
+  if (clock)
+    g_signal_connect(clock, "after-paint", G_CALLBACK(on_after_paint), w);
+}
+
+/*
+ * Signal: realize — each realization brings a new frame clock.
+ */
+static void on_realize(GtkWidget *widget, gpointer data) {
+  connect_frame_clock(widget, data);
+}
+
+/*
+ * Signal: destroy — stop watching; the window's last span is flushed first
+ * so a destroyed window takes no share of later ones.
+ */
+static void on_destroy(GtkWidget *widget, gpointer data) {
+  struct window_watch *w = data;
+  flush_before_change();
+
+  GdkFrameClock *clock = gtk_widget_get_frame_clock(widget);
+  if (clock)
+    g_signal_handlers_disconnect_by_data(clock, w);
+  g_signal_handlers_disconnect_by_data(widget, w);
+  g_object_set_data(G_OBJECT(widget), "tauri-spy-window-watch", NULL);
+
+  watches = g_list_remove(watches, w);
+  g_free(w->webviews);
+  g_free(w);
+}
+
+static void collect_webviews(GtkWidget *widget, GString *ids) {
+  if (WEBKIT_IS_WEB_VIEW(widget)) {
+    g_string_append_printf(ids, "%s%d", ids->len > 1 ? "," : "",
+                           spy_webview_id(WEBKIT_WEB_VIEW(widget)));
+  }
+  if (!GTK_IS_CONTAINER(widget))
+    return;
+
+  GList *children = gtk_container_get_children(GTK_CONTAINER(widget));
+  for (GList *l = children; l != NULL; l = l->next)
+    collect_webviews(GTK_WIDGET(l->data), ids);
+  g_list_free(children);
+}
+
+/* JSON array of the ids of the webviews inside a window */
+static char *webviews_json(GtkWidget *window) {
+  GString *ids = g_string_new("[");
+  collect_webviews(window, ids);
+  g_string_append_c(ids, ']');
+  return g_string_free(ids, FALSE);
+}
+
+/*
+ * Start watching a toplevel (once per window) if the "hidden-windows" probe
+ * was selected. Called from spy.c for every toplevel holding a webview.
+ */
+void spy_windows_watch(GtkWindow *window) {
+  if (!spy_recorder_active() || !spy_probe_enabled("hidden-windows"))
+    return;
+  if (g_object_get_data(G_OBJECT(window), "tauri-spy-window-watch"))
+    return;
+
+  GtkWidget *widget = GTK_WIDGET(window);
+  struct window_watch *w = g_new0(struct window_watch, 1);
+  w->id = next_window_id++;
+  w->mapped = gtk_widget_get_mapped(widget);
+  if (gtk_widget_get_window(widget))
+    w->state = gdk_window_get_state(gtk_widget_get_window(widget));
+
+  w->webviews = webviews_json(widget);
+
+  g_object_set_data(G_OBJECT(window), "tauri-spy-window-watch", w);
+
+  gtk_widget_add_events(widget, GDK_VISIBILITY_NOTIFY_MASK);
+  g_signal_connect(widget, "window-state-event", G_CALLBACK(on_window_state),
+                   w);
+  g_signal_connect(widget, "map-event", G_CALLBACK(on_map_changed), w);
+  g_signal_connect(widget, "unmap-event", G_CALLBACK(on_map_changed), w);
+  g_signal_connect(widget, "visibility-notify-event",
+                   G_CALLBACK(on_visibility), w);
+  g_signal_connect(widget, "realize", G_CALLBACK(on_realize), w);
+  g_signal_connect(widget, "destroy", G_CALLBACK(on_destroy), w);
+  if (gtk_widget_get_realized(widget))
+    connect_frame_clock(widget, w);
+
+  if (!watches) {
+    last_cpu_us = process_cpu_us();
+    last_energy_uj = package_energy_uj();
+    last_flush_us = spy_now_us();
+  } else {
+    flush_before_change();
+  }
+  watches = g_list_append(watches, w);
+  record_state(w);
+}
+
+/*
+ * Watch the toplevel a webview sits in, or refresh its webview list when
+ * the window is already watched and gained a webview.
+ */
+static void watch_toplevel_of(GtkWidget *webview) {
+  GtkWidget *toplevel = gtk_widget_get_toplevel(webview);
+  if (!GTK_IS_WINDOW(toplevel) || !gtk_widget_is_toplevel(toplevel))
+    return;
+
+  struct window_watch *w =
+      g_object_get_data(G_OBJECT(toplevel), "tauri-spy-window-watch");
+  if (!w) {
+    spy_windows_watch(GTK_WINDOW(toplevel));
+    return;
+  }
+
+  char *ids = webviews_json(toplevel);
+  if (strcmp(ids, w->webviews) == 0) {
+    g_free(ids);
+    return;
+  }
+  flush_before_change();
+  g_free(w->webviews);
+  w->webviews = ids;
+  record_state(w);
+}
+
+/*
+ * Signal: hierarchy-changed — the webview was put into (or moved to) a
+ * window.
+ */
+static void on_hierarchy_changed(GtkWidget *widget, GtkWidget *previous,
+                                 gpointer data) {
+  (void)previous;
+  (void)data;
+  watch_toplevel_of(widget);
+}
+
+/*
+ * Follow a webview into whichever window it ends up in, so windows created
+ * after spy.c's startup scan are watched too. Called from channel.c for
+ * every webview, often before it has a parent.
+ */
+void spy_windows_track(WebKitWebView *view) {
+  if (!spy_recorder_active() || !spy_probe_enabled("hidden-windows"))
+    return;
+  if (g_object_get_data(G_OBJECT(view), "tauri-spy-window-track"))
+    return;
+  g_object_set_data(G_OBJECT(view), "tauri-spy-window-track",
+                    GINT_TO_POINTER(1));
+
+  g_signal_connect(view, "hierarchy-changed",
+                   G_CALLBACK(on_hierarchy_changed), NULL);
+  watch_toplevel_of(GTK_WIDGET(view));
+}
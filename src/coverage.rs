@@ -0,0 +1,408 @@
+//! `tauri-spy coverage` — how much of the frontend's JS actually runs
+//!
+//! The target is launched with JSC's control-flow profiler switched on
+//! (`JSC_useControlFlowProfiler=1`, inherited by the web process) and with
+//! WebKitGTK's remote inspector served on a local port. Once the scenario is
+//! done (Enter, or `--duration`), every page target is asked over the
+//! inspector protocol for its scripts (`Debugger.scriptParsed`), their
+//! sources and their basic blocks (`Runtime.getBasicBlocks`).
+//!
+//! Blocks nest: a function that never ran is one unexecuted range, and the
+//! blocks of a function that did run lie inside its range. Painting the
+//! blocks largest first lets the innermost block decide each character.
+//! Offsets are UTF-16 code units, as JSC counts them; for minified bundles
+//! that is one per byte.
+
+use crate::inspector::{self, Inspector};
+use crate::report::heading;
+use crate::sourcemap::Resolver;
+use crate::wait_for_scenario;
+use colored::Colorize;
+use serde_json::{json, Value};
+use std::collections::HashMap;
+use std::path::PathBuf;
+use std::process::Command;
+use std::time::Duration;
+
+/// Never-run stretches smaller than this are not listed on their own
+const MIN_REGION_CHARS: usize = 1024;
+
+/// Granularity of the per-source breakdown through source maps
+const SOURCE_SAMPLE_CHARS: usize = 64;
+
+/// How long to wait for the inspector server once collection starts
+const CONNECT_TIMEOUT: Duration = Duration::from_secs(10);
+
+const UNKNOWN: u8 = 0;
+const RAN: u8 = 1;
+const NEVER_RAN: u8 = 2;
+
+pub struct Options {
+    pub port: u16,
+    pub duration: Option<u64>,
+    pub source_maps: Option<PathBuf>,
+    pub top: usize,
+}
+
+struct Script {
+    url: String,
+    chars: usize,
+    ran: usize,
+    never_ran: usize,
+    /// (start, length) of every never-run stretch, in source order
+    never_ranges: Vec<(usize, usize)>,
+    source: Vec<u16>,
+    line_starts: Vec<usize>,
+}
+
+impl Script {
+    fn new(url: String, source: &str, blocks: &[Value]) -> Script {
+        let source: Vec<u16> = source.encode_utf16().collect();
+        let mut line_starts = vec![0];
+        line_starts.extend(
+            source
+                .iter()
+                .enumerate()
+                .filter(|(_, &c)| c == b'\n' as u16)
+                .map(|(i, _)| i + 1),
+        );
+
+        let mut ranges: Vec<(usize, usize, bool)> = blocks
+            .iter()
+            .filter_map(|b| {
+                let start = b.get("startOffset")?.as_u64()? as usize;
+                let end = b.get("endOffset")?.as_u64()? as usize;
+                let ran = b.get("hasExecuted")?.as_bool()?;
+                Some((start.min(source.len()), end.min(source.len()), ran))
+            })
+            .filter(|(start, end, _)| start < end)
+            .collect();
+        ranges.sort_by_key(|(start, end, _)| std::cmp::Reverse(end - start));
+
+        let mut state = vec![UNKNOWN; source.len()];
+        for (start, end, ran) in ranges {
+            let value = if ran { RAN } else { NEVER_RAN };
+            state[start..end].fill(value);
+        }
+
+        let mut never_ranges = Vec::new();
+        let mut start = None;
+        for (i, &s) in state.iter().chain([UNKNOWN].iter()).enumerate() {
+            match (s == NEVER_RAN, start) {
+                (true, None) => start = Some(i),
+                (false, Some(from)) => {
+                    never_ranges.push((from, i - from));
+                    start = None;
+                }
+                _ => {}
+            }
+        }
+
+        Script {
+            url,
+            chars: source.len(),
+            ran: state.iter().filter(|&&s| s == RAN).count(),
+            never_ran: never_ranges.iter().map(|&(_, length)| length).sum(),
+            never_ranges,
+            source,
+            line_starts,
+        }
+    }
+
+    /// 0-based line and column of an offset
+    fn position(&self, offset: usize) -> (usize, usize) {
+        let line = self.line_starts.partition_point(|&s| s <= offset) - 1;
+        (line, offset - self.line_starts[line])
+    }
+
+    /// The first few characters at an offset, on one line
+    fn snippet(&self, offset: usize) -> String {
+        let end = (offset + 48).min(self.source.len());
+        let text = String::from_utf16_lossy(&self.source[offset..end]);
+        text.lines().next().unwrap_or("").trim().to_string()
+    }
+}
+
+fn percent(part: usize, whole: usize) -> f64 {
+    if whole == 0 {
+        0.0
+    } else {
+        part as f64 * 100.0 / whole as f64
+    }
+}
+
+fn kb(chars: usize) -> String {
+    format!("{:.1}", chars as f64 / 1024.0)
+}
+
+/// Scripts of one page target with their coverage
+fn collect(addr: &str, path: &str) -> Result<(Vec<Script>, usize), String> {
+    let mut inspector = Inspector::connect(addr, path)?;
+    inspector.call("Debugger.enable", json!({}))?;
+
+    let mut parsed: Vec<(String, String)> = Vec::new();
+    let mut anonymous = 0;
+    for event in inspector.events.drain(..) {
+        if event.get("method").and_then(Value::as_str) != Some("Debugger.scriptParsed") {
+            continue;
+        }
+        let params = &event["params"];
+        let id = params["scriptId"].as_str().unwrap_or("").to_string();
+        let url = params
+            .get("sourceURL")
+            .and_then(Value::as_str)
+            .filter(|u| !u.is_empty())
+            .or_else(|| params.get("url").and_then(Value::as_str))
+            .unwrap_or("");
+        if url.starts_with("tauri-spy://") {
+            continue;
+        }
+        if url.is_empty() {
+            anonymous += 1;
+            continue;
+        }
+        parsed.push((id, url.to_string()));
+    }
+
+    let mut scripts = Vec::new();
+    for (id, url) in parsed {
+        let source = inspector.call("Debugger.getScriptSource", json!({ "scriptId": id }))?;
+        let blocks = inspector.call("Runtime.getBasicBlocks", json!({ "sourceID": id }))?;
+        let source = source["scriptSource"].as_str().unwrap_or("");
+        let blocks = blocks["basicBlocks"].as_array().map(Vec::as_slice);
+        scripts.push(Script::new(url, source, blocks.unwrap_or(&[])));
+    }
+    let _ = inspector.call("Debugger.disable", json!({}));
+
+    // One entry per URL: a script evaluated twice keeps the better-covered copy
+    let mut by_url: HashMap<String, Script> = HashMap::new();
+    for script in scripts {
+        match by_url.get(&script.url) {
+            Some(kept) if kept.ran >= script.ran => {}
+            _ => {
+                by_url.insert(script.url.clone(), script);
+            }
+        }
+    }
+    let mut scripts: Vec<Script> = by_url.into_values().collect();
+    scripts.sort_by_key(|s| std::cmp::Reverse(s.never_ran));
+    Ok((scripts, anonymous))
+}
+
+fn print(path: &str, scripts: &[Script], anonymous: usize, resolver: &mut Resolver, top: usize) {
+    heading(&format!("Coverage of {}", path));
+
+    let chars: usize = scripts.iter().map(|s| s.chars).sum();
+    let ran: usize = scripts.iter().map(|s| s.ran).sum();
+    let never_ran: usize = scripts.iter().map(|s| s.never_ran).sum();
+    println!(
+        "  {} script(s), {} KB of JS: {} KB ({:.0}%) ran, {} KB ({:.0}%) never ran",
+        scripts.len(),
+        kb(chars),
+        kb(ran),
+        percent(ran, chars),
+        kb(never_ran),
+        percent(never_ran, chars)
+    );
+    if anonymous > 0 {
+        println!(
+            "  {} {} eval'd or inline script(s) without a URL skipped",
+            "note:".cyan().bold(),
+            anonymous
+        );
+    }
+
+    println!(
+        "    {:>9} {:>9} {:>6} {:>11}  script",
+        "KB", "ran KB", "ran %", "never KB"
+    );
+    for s in scripts.iter().take(top) {
+        println!(
+            "    {:>9} {:>9} {:>6.0} {:>11}  {}",
+            kb(s.chars),
+            kb(s.ran),
+            percent(s.ran, s.chars),
+            kb(s.never_ran),
+            s.url
+        );
+    }
+
+    let mut regions: Vec<(&Script, usize, usize)> = scripts
+        .iter()
+        .flat_map(|s| {
+            let ranges = s.never_ranges.iter();
+            ranges.map(move |&(start, length)| (s, start, length))
+        })
+        .filter(|&(_, _, length)| length >= MIN_REGION_CHARS)
+        .collect();
+    regions.sort_by_key(|&(_, _, length)| std::cmp::Reverse(length));
+    if !regions.is_empty() {
+        println!("  Largest code that never ran:");
+    }
+    for (script, start, length) in regions.into_iter().take(top) {
+        let (line, column) = script.position(start);
+        let frame = format!("{}:{}:{}", script.url, line + 1, column + 1);
+        let location = resolver.resolve(&frame).unwrap_or(frame);
+        println!(
+            "    {:>9} KB  {}  {}",
+            kb(length),
+            location,
+            script.snippet(start).dimmed()
+        );
+    }
+
+    print_sources(scripts, resolver, top);
+}
+
+/// Coverage per original source file, for scripts with a source map. Each
+/// SOURCE_SAMPLE_CHARS stretch counts towards the source its start maps to.
+fn print_sources(scripts: &[Script], resolver: &mut Resolver, top: usize) {
+    let mut sources: HashMap<String, (usize, usize)> = HashMap::new();
+    for script in scripts {
+        let Some(map) = resolver.map(&script.url) else {
+            continue;
+        };
+        let ranges = &script.never_ranges;
+        for start in (0..script.chars).step_by(SOURCE_SAMPLE_CHARS) {
+            let (line, column) = script.position(start);
+            let Some((source, _, _)) = map.lookup(line as u32, column as u32) else {
+                continue;
+            };
+            let length = SOURCE_SAMPLE_CHARS.min(script.chars - start);
+            let entry = sources.entry(source.to_string()).or_default();
+            entry.0 += length;
+            let index = ranges.partition_point(|&(s, _)| s <= start);
+            if index > 0 && start < ranges[index - 1].0 + ranges[index - 1].1 {
+                entry.1 += length;
+            }
+        }
+    }
+    if sources.is_empty() {
+        return;
+    }
+
+    let mut sources: Vec<_> = sources.into_iter().collect();
+    sources.sort_by_key(|(_, (_, never))| std::cmp::Reverse(*never));
+    println!("  By original source:");
+    println!(
+        "    {:>9} {:>11} {:>8}  source",
+        "KB", "never KB", "never %"
+    );
+    for (source, (chars, never)) in sources.iter().take(top) {
+        println!(
+            "    {:>9} {:>11} {:>8.0}  {}",
+            kb(*chars),
+            kb(*never),
+            percent(*never, *chars),
+            source
+        );
+    }
+}
+
+pub fn run(mut command: Command, options: &Options) -> Result<(), String> {
+    let addr = format!("127.0.0.1:{}", options.port);
+    command
+        .env("WEBKIT_INSPECTOR_HTTP_SERVER", &addr)
+        .env("JSC_useControlFlowProfiler", "1");
+    println!(
+        "{} Control-flow profiler on, inspector at {}",
+        "       >>>".cyan(),
+        addr.dimmed()
+    );
+
+    let mut child = command
+        .spawn()
+        .map_err(|e| format!("Failed to launch target: {}", e))?;
+    match options.duration {
+        Some(secs) => println!("{} Collecting coverage in {} s", "       >>>".cyan(), secs),
+        None => println!(
+            "{} Run your scenario, then press Enter to collect coverage",
+            "       >>>".cyan()
+        ),
+    }
+    let waited = match wait_for_scenario(&mut child, options.duration) {
+        Some(status) => Err(format!(
+            "Target exited ({}) before coverage was collected",
+            status
+        )),
+        None => Ok(()),
+    };
+    let result = waited.and_then(|()| {
+        let mut resolver = Resolver::new(options.source_maps.as_deref());
+        let paths = inspector::wait_for_targets(&addr, CONNECT_TIMEOUT)?;
+        let mut failed = Vec::new();
+        for path in &paths {
+            // One page that cannot be read must not cost the others
+            match collect(&addr, path) {
+                Ok((scripts, anonymous)) => {
+                    print(path, &scripts, anonymous, &mut resolver, options.top)
+                }
+                Err(e) => {
+                    eprintln!("{} {}: {}", "warning:".yellow().bold(), path, e);
+                    failed.push(e);
+                }
+            }
+        }
+        if failed.len() == paths.len() {
+            return Err(failed.pop().unwrap_or_default());
+        }
+        for error in &resolver.errors {
+            println!(
+                "  {} skipped source map {}",
+                "warning:".yellow().bold(),
+                error
+            );
+        }
+        Ok(())
+    });
+
+    let _ = child.kill();
+    let _ = child.wait();
+    result
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn block(start: u64, end: u64, ran: bool) -> Value {
+        json!({ "startOffset": start, "endOffset": end, "hasExecuted": ran })
+    }
+
+    /// 40 characters over two lines
+    const SOURCE: &str = "function run(){if(a){b()}else{c()}}\nd();";
+
+    #[test]
+    fn paints_smaller_blocks_over_larger_ones() {
+        let blocks = [
+            // Listed innermost first: painting goes by size, not order
+            block(15, 20, true),
+            block(10, 30, false),
+            block(0, 40, true),
+            // Runs past the end of the script
+            block(35, 60, false),
+            block(12, 12, false),
+            json!({ "startOffset": 0, "endOffset": 40 }),
+        ];
+        let script = Script::new("app.js".to_string(), SOURCE, &blocks);
+
+        assert_eq!(script.chars, 40);
+        assert_eq!(script.never_ranges, vec![(10, 5), (20, 10), (35, 5)]);
+        assert_eq!(script.never_ran, 20);
+        assert_eq!(script.ran, 20);
+    }
+
+    #[test]
+    fn leaves_uncovered_text_out_of_both_counts() {
+        // Offsets count UTF-16 units: the emoji takes two
+        let source = "let s = \"😀\";\nf();";
+        let blocks = [block(0, 5, true), block(14, 18, false)];
+        let script = Script::new("app.js".to_string(), source, &blocks);
+
+        assert_eq!(script.chars, 18);
+        assert_eq!(script.ran, 5);
+        assert_eq!(script.never_ranges, vec![(14, 4)]);
+        assert_eq!(script.position(14), (1, 0));
+        assert_eq!(script.snippet(14), "f();");
+    }
+}
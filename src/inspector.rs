@@ -0,0 +1,399 @@
+//! Minimal client for WebKitGTK's remote Web Inspector
+//!
+//! With `WEBKIT_INSPECTOR_HTTP_SERVER=host:port` in its environment, a
+//! WebKitGTK app serves the inspector over plain HTTP: the index page lists
+//! the inspectable targets as `/socket/<connection>/<target>/<type>` links,
+//! and each link is a WebSocket carrying inspector protocol JSON. That is
+//! all this module speaks — an HTTP/1.1 GET, the WebSocket handshake and
+//! unextended text frames — so the CLI needs no networking dependencies.
+//!
+//! Page targets (`WebPage`) talk through the Target domain: commands are
+//! wrapped in `Target.sendMessageToTarget` for the page target announced by
+//! `Target.targetCreated`, and replies come back inside
+//! `Target.dispatchMessageFromTarget`. [`Inspector::call`] hides both.
+
+use serde_json::{json, Value};
+use std::io::{Read, Write};
+use std::net::TcpStream;
+use std::time::{Duration, Instant, SystemTime, UNIX_EPOCH};
+
+/// How long to wait for a command's reply
+const CALL_TIMEOUT: Duration = Duration::from_secs(30);
+
+/// How long to listen for Target.targetCreated after connecting
+const TARGET_WAIT: Duration = Duration::from_millis(1000);
+
+/// How often to ask the inspector server for targets while waiting
+const TARGET_POLL: Duration = Duration::from_millis(200);
+
+const OP_CONTINUATION: u8 = 0x0;
+const OP_TEXT: u8 = 0x1;
+const OP_CLOSE: u8 = 0x8;
+const OP_PING: u8 = 0x9;
+const OP_PONG: u8 = 0xA;
+
+/// Cheap pseudo-random bytes for the handshake key and frame masks; the
+/// connection is local, so nothing here needs to be unpredictable
+struct Noise(u64);
+
+impl Noise {
+    fn new() -> Noise {
+        let nanos = SystemTime::now()
+            .duration_since(UNIX_EPOCH)
+            .map(|d| d.as_nanos() as u64)
+            .unwrap_or(0);
+        Noise((nanos ^ ((std::process::id() as u64) << 32)) | 1)
+    }
+
+    fn next(&mut self) -> u32 {
+        self.0 ^= self.0 << 13;
+        self.0 ^= self.0 >> 7;
+        self.0 ^= self.0 << 17;
+        (self.0 >> 32) as u32
+    }
+}
+
+fn base64(bytes: &[u8]) -> String {
+    const ALPHABET: &[u8] = b"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    let mut out = String::new();
+    for chunk in bytes.chunks(3) {
+        let n = chunk
+            .iter()
+            .enumerate()
+            .fold(0u32, |n, (i, &b)| n | (b as u32) << (16 - 8 * i));
+        for i in 0..4 {
+            if i <= chunk.len() {
+                out.push(ALPHABET[(n >> (18 - 6 * i) & 63) as usize] as char);
+            } else {
+                out.push('=');
+            }
+        }
+    }
+    out
+}
+
+/// Send a request line and headers, and read the response up to the end of
+/// its headers. Returns the status line, headers and any body bytes read
+/// past them.
+fn request(stream: &mut TcpStream, head: &str) -> Result<(String, Vec<u8>), String> {
+    stream
+        .write_all(head.as_bytes())
+        .map_err(|e| format!("Failed to send request: {}", e))?;
+
+    let mut response = Vec::new();
+    let mut buf = [0u8; 4096];
+    loop {
+        if let Some(end) = response.windows(4).position(|w| w == b"\r\n\r\n") {
+            let headers = String::from_utf8_lossy(&response[..end]).to_string();
+            return Ok((headers, response[end + 4..].to_vec()));
+        }
+        let n = stream
+            .read(&mut buf)
+            .map_err(|e| format!("Failed to read response: {}", e))?;
+        if n == 0 {
+            return Err("Connection closed before the response headers".to_string());
+        }
+        response.extend_from_slice(&buf[..n]);
+    }
+}
+
+/// Socket paths of the inspectable targets listed by the inspector server
+/// at `addr`, e.g. "/socket/1/2/WebPage"
+pub fn targets(addr: &str) -> Result<Vec<String>, String> {
+    let mut stream = TcpStream::connect(addr)
+        .map_err(|e| format!("Could not reach the inspector at {}: {}", addr, e))?;
+    stream.set_read_timeout(Some(CALL_TIMEOUT)).ok();
+    let head = format!(
+        "GET / HTTP/1.1\r\nHost: {}\r\nConnection: close\r\n\r\n",
+        addr
+    );
+    let (_, mut body) = request(&mut stream, &head)?;
+    stream
+        .read_to_end(&mut body)
+        .map_err(|e| format!("Failed to read the target list: {}", e))?;
+
+    let page = String::from_utf8_lossy(&body);
+    let mut paths: Vec<String> = Vec::new();
+    for (at, _) in page.match_indices("/socket/") {
+        let path: String = page[at..]
+            .chars()
+            .take_while(|c| c.is_ascii_alphanumeric() || *c == '/' || *c == '_')
+            .collect();
+        // Three parts after /socket/; the page's own script has none
+        if path.matches('/').count() == 4 && !paths.contains(&path) {
+            paths.push(path);
+        }
+    }
+    Ok(paths)
+}
+
+/// Wait up to `timeout` for the inspector server to come up and list at
+/// least one target
+pub fn wait_for_targets(addr: &str, timeout: Duration) -> Result<Vec<String>, String> {
+    let deadline = Instant::now() + timeout;
+    loop {
+        let error = match targets(addr) {
+            Ok(paths) if !paths.is_empty() => return Ok(paths),
+            Ok(_) => "the inspector lists no targets".to_string(),
+            Err(e) => e,
+        };
+        if Instant::now() >= deadline {
+            return Err(format!(
+                "{} — does the app's WebKitGTK have the remote inspector?",
+                error
+            ));
+        }
+        std::thread::sleep(TARGET_POLL);
+    }
+}
+
+/// One inspector connection
+pub struct Inspector {
+    stream: TcpStream,
+    /// Frame bytes that arrived along with the handshake response
+    pending: Vec<u8>,
+    noise: Noise,
+    next_id: u64,
+    /// Page target to wrap commands for, once announced
+    target: Option<String>,
+    /// Events received while waiting for replies, in arrival order
+    pub events: Vec<Value>,
+}
+
+impl Inspector {
+    pub fn connect(addr: &str, path: &str) -> Result<Inspector, String> {
+        let mut stream = TcpStream::connect(addr)
+            .map_err(|e| format!("Could not reach the inspector at {}: {}", addr, e))?;
+        stream.set_read_timeout(Some(CALL_TIMEOUT)).ok();
+
+        let mut noise = Noise::new();
+        let key: Vec<u8> = (0..4).flat_map(|_| noise.next().to_le_bytes()).collect();
+        let head = format!(
+            "GET {} HTTP/1.1\r\nHost: {}\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n\
+             Sec-WebSocket-Key: {}\r\nSec-WebSocket-Version: 13\r\n\r\n",
+            path,
+            addr,
+            base64(&key)
+        );
+        let (headers, rest) = request(&mut stream, &head)?;
+        if !headers.starts_with("HTTP/1.1 101") {
+            let status = headers.lines().next().unwrap_or("").to_string();
+            return Err(format!("Inspector refused {}: {}", path, status));
+        }
+        let mut inspector = Inspector {
+            stream,
+            pending: rest,
+            noise,
+            next_id: 1,
+            target: None,
+            events: Vec::new(),
+        };
+        inspector.find_page_target()?;
+        Ok(inspector)
+    }
+
+    fn send_frame(&mut self, opcode: u8, payload: &[u8]) -> Result<(), String> {
+        let mut frame = vec![0x80 | opcode];
+        match payload.len() {
+            n if n < 126 => frame.push(0x80 | n as u8),
+            n if n <= 0xffff => {
+                frame.push(0x80 | 126);
+                frame.extend_from_slice(&(n as u16).to_be_bytes());
+            }
+            n => {
+                frame.push(0x80 | 127);
+                frame.extend_from_slice(&(n as u64).to_be_bytes());
+            }
+        }
+        let mask = self.noise.next().to_be_bytes();
+        frame.extend_from_slice(&mask);
+        frame.extend(payload.iter().enumerate().map(|(i, b)| b ^ mask[i % 4]));
+        self.stream
+            .write_all(&frame)
+            .map_err(|e| format!("Failed to send to the inspector: {}", e))
+    }
+
+    /// Next `n` bytes. Bytes read before a timeout stay in `pending`, so a
+    /// timed-out read can be retried without losing part of a frame.
+    fn read_exact(&mut self, n: usize) -> Result<Vec<u8>, std::io::Error> {
+        let mut chunk = [0u8; 64 * 1024];
+        while self.pending.len() < n {
+            match self.stream.read(&mut chunk) {
+                Ok(0) => return Err(std::io::ErrorKind::UnexpectedEof.into()),
+                Ok(read) => self.pending.extend_from_slice(&chunk[..read]),
+                Err(e) if e.kind() == std::io::ErrorKind::Interrupted => {}
+                Err(e) => return Err(e),
+            }
+        }
+        Ok(self.pending.drain(..n).collect())
+    }
+
+    /// Next text message, answering pings on the way. None on timeout.
+    fn read_message(&mut self) -> Result<Option<String>, String> {
+        let mut message = Vec::new();
+        loop {
+            let header = match self.read_exact(2) {
+                Ok(header) => header,
+                Err(e)
+                    if message.is_empty()
+                        && matches!(
+                            e.kind(),
+                            std::io::ErrorKind::WouldBlock | std::io::ErrorKind::TimedOut
+                        ) =>
+                {
+                    return Ok(None)
+                }
+                Err(e) => return Err(format!("Failed to read from the inspector: {}", e)),
+            };
+            // A short poll timeout must not cut a frame in half
+            self.stream.set_read_timeout(Some(CALL_TIMEOUT)).ok();
+            let io = |e: std::io::Error| format!("Failed to read from the inspector: {}", e);
+            let fin = header[0] & 0x80 != 0;
+            let opcode = header[0] & 0x0f;
+            let mut length = (header[1] & 0x7f) as u64;
+            if length == 126 {
+                let b = self.read_exact(2).map_err(io)?;
+                length = u16::from_be_bytes([b[0], b[1]]) as u64;
+            } else if length == 127 {
+                let b = self.read_exact(8).map_err(io)?;
+                length = u64::from_be_bytes(b.try_into().unwrap());
+            }
+            let mask = if header[1] & 0x80 != 0 {
+                Some(self.read_exact(4).map_err(io)?)
+            } else {
+                None
+            };
+            let mut payload = self.read_exact(length as usize).map_err(io)?;
+            if let Some(mask) = mask {
+                payload
+                    .iter_mut()
+                    .enumerate()
+                    .for_each(|(i, b)| *b ^= mask[i % 4]);
+            }
+
+            match opcode {
+                OP_PING => self.send_frame(OP_PONG, &payload)?,
+                OP_CLOSE => return Err("The inspector closed the connection".to_string()),
+                OP_TEXT | OP_CONTINUATION => {
+                    message.extend_from_slice(&payload);
+                    if fin {
+                        return Ok(Some(String::from_utf8_lossy(&message).to_string()));
+                    }
+                }
+                _ => {}
+            }
+        }
+    }
+
+    /// Next protocol message, unwrapped from Target.dispatchMessageFromTarget
+    fn receive(&mut self) -> Result<Option<Value>, String> {
+        let Some(text) = self.read_message()? else {
+            return Ok(None);
+        };
+        let message: Value = serde_json::from_str(&text)
+            .map_err(|e| format!("Malformed inspector message: {}", e))?;
+        let method = message.get("method").and_then(Value::as_str);
+        if method == Some("Target.didCommitProvisionalTarget") {
+            // A navigation swapped the page into a new process
+            let id = message
+                .pointer("/params/newTargetId")
+                .and_then(Value::as_str);
+            if self.target.is_some() {
+                self.target = id.map(str::to_string);
+            }
+        }
+        if method == Some("Target.dispatchMessageFromTarget") {
+            let inner = message
+                .pointer("/params/message")
+                .and_then(Value::as_str)
+                .unwrap_or("{}");
+            return serde_json::from_str(inner)
+                .map(Some)
+                .map_err(|e| format!("Malformed inspector message: {}", e));
+        }
+        Ok(Some(message))
+    }
+
+    /// Next protocol message within `timeout`
+    fn receive_within(&mut self, timeout: Duration) -> Result<Option<Value>, String> {
+        let timeout = timeout.max(Duration::from_millis(1));
+        self.stream.set_read_timeout(Some(timeout)).ok();
+        let message = self.receive();
+        self.stream.set_read_timeout(Some(CALL_TIMEOUT)).ok();
+        message
+    }
+
+    /// Next event, oldest first: those kept by `call` and then new ones
+    /// arriving within `timeout`
+    pub fn next_event(&mut self, timeout: Duration) -> Result<Option<Value>, String> {
+        if !self.events.is_empty() {
+            return Ok(Some(self.events.remove(0)));
+        }
+        self.receive_within(timeout)
+    }
+
+    /// Listen briefly for the page target a WebPage connection announces
+    fn find_page_target(&mut self) -> Result<(), String> {
+        let deadline = Instant::now() + TARGET_WAIT;
+        while Instant::now() < deadline {
+            match self.receive_within(Duration::from_millis(100))? {
+                Some(event) => {
+                    let info = event.pointer("/params/targetInfo");
+                    let kind = info.and_then(|i| i.get("type")).and_then(Value::as_str);
+                    if event.get("method").and_then(Value::as_str) == Some("Target.targetCreated")
+                        && kind == Some("page")
+                    {
+                        let id = info.and_then(|i| i.get("targetId")).and_then(Value::as_str);
+                        self.target = id.map(str::to_string);
+                    } else {
+                        self.events.push(event);
+                    }
+                }
+                None if self.target.is_some() => break,
+                None => {}
+            }
+        }
+        Ok(())
+    }
+
+    /// Send a command and wait for its result; events that arrive meanwhile
+    /// are kept in `events`
+    pub fn call(&mut self, method: &str, params: Value) -> Result<Value, String> {
+        let id = self.next_id;
+        self.next_id += 1;
+        let command = json!({ "id": id, "method": method, "params": params }).to_string();
+        let outer_id = self.next_id;
+        let outer = match &self.target {
+            Some(target) => {
+                self.next_id += 1;
+                json!({
+                    "id": outer_id,
+                    "method": "Target.sendMessageToTarget",
+                    "params": { "targetId": target, "message": command },
+                })
+                .to_string()
+            }
+            None => command,
+        };
+        self.send_frame(OP_TEXT, outer.as_bytes())?;
+
+        loop {
+            let Some(message) = self.receive()? else {
+                return Err(format!("{} timed out", method));
+            };
+            let reply = message.get("id").and_then(Value::as_u64);
+            if reply != Some(id) && (reply != Some(outer_id) || message.get("error").is_none()) {
+                // The wrapper's own successful reply carries nothing
+                if message.get("method").is_some() {
+                    self.events.push(message);
+                }
+                continue;
+            }
+            if let Some(error) = message.get("error") {
+                let text = error.get("message").and_then(Value::as_str).unwrap_or("?");
+                return Err(format!("{} failed: {}", method, text));
+            }
+            return Ok(message.get("result").cloned().unwrap_or(Value::Null));
+        }
+    }
+}
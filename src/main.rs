@@ -1,21 +1,184 @@
-use clap::Parser;
+mod coverage;
+mod inspector;
+mod perf;
+mod report;
+mod sourcemap;
+mod startup;
+
+use clap::builder::PossibleValuesParser;
+use clap::{Args, Parser, Subcommand};
 use colored::Colorize;
 use std::env;
 use std::fs;
+use std::io::BufRead;
 use std::path::{Path, PathBuf};
-use std::process::{Command, ExitCode};
+use std::process::{Child, Command, ExitCode, ExitStatus};
+use std::sync::mpsc;
+use std::thread;
+use std::time::{Duration, Instant};
+
+/// Opt-in libspy probes, selectable with --probe (inject/probes/*.js and
+/// native probes; "all" enables every one)
+const PROBES: &[&str] = &[
+    "all",
+    "animations",
+    "canvas",
+    "components",
+    "console",
+    "dom-mutations",
+    "hidden-windows",
+    "images",
+    "indexeddb",
+    "ipc-channels",
+    "layout-thrash",
+    "long-tasks",
+    "raf",
+    "scroll-listeners",
+    "source-maps",
+    "storage",
+    "timers",
+    "wakeups",
+    "wasm",
+    "workers",
+];
 
 /// Enable WebKitGTK DevTools in Tauri release builds
 #[derive(Parser)]
-#[command(name = "tauri-spy", version, about, long_about = None)]
+#[command(
+    name = "tauri-spy",
+    version,
+    about,
+    long_about = None,
+    args_conflicts_with_subcommands = true,
+    subcommand_negates_reqs = true
+)]
 struct Cli {
+    #[command(subcommand)]
+    command: Option<Commands>,
+
+    #[command(flatten)]
+    launch: LaunchArgs,
+}
+
+#[derive(Subcommand)]
+enum Commands {
+    /// Summarize a telemetry report recorded with --report
+    Report {
+        /// Path to the JSON-lines report file
+        file: PathBuf,
+
+        /// Also write component renders as folded stacks for a flamegraph
+        #[arg(long, value_name = "FILE")]
+        flamegraph: Option<PathBuf>,
+
+        /// Resolve JS stack frames through the source maps in this directory
+        #[arg(long, value_name = "DIR")]
+        source_maps: Option<PathBuf>,
+    },
+
+    /// Launch the target and report which of its JS ran during a scenario
+    Coverage {
+        /// Path to the target Tauri application binary
+        target: PathBuf,
+
+        /// Collect after this many seconds instead of waiting for Enter
+        #[arg(long, value_name = "SECS")]
+        duration: Option<u64>,
+
+        /// Local port for WebKitGTK's remote inspector
+        #[arg(long, default_value_t = 9226)]
+        port: u16,
+
+        /// Map never-run code to original sources through these source maps
+        #[arg(long, value_name = "DIR")]
+        source_maps: Option<PathBuf>,
+
+        /// How many scripts, regions and sources to list
+        #[arg(long, default_value_t = 15)]
+        top: usize,
+
+        /// Additional arguments to pass to the target application
+        #[arg(trailing_var_arg = true, allow_hyphen_values = true)]
+        args: Vec<String>,
+    },
+
+    /// Break the page load's JS down per script: size, serve, parse, run
+    Startup {
+        /// Path to the target Tauri application binary
+        target: PathBuf,
+
+        /// Keep recording this many seconds past the load event
+        #[arg(long, value_name = "SECS", default_value_t = 2)]
+        settle: u64,
+
+        /// Local port for WebKitGTK's remote inspector
+        #[arg(long, default_value_t = 9226)]
+        port: u16,
+
+        /// Additional arguments to pass to the target application
+        #[arg(trailing_var_arg = true, allow_hyphen_values = true)]
+        args: Vec<String>,
+    },
+
+    /// Profile the target with perf, JIT'ed JS frames included, as a flamegraph
+    PerfRecord {
+        /// Path to the target Tauri application binary
+        target: PathBuf,
+
+        /// Write folded stacks for a flamegraph to this file
+        #[arg(long, short, value_name = "FILE", default_value = "perf.folded")]
+        output: PathBuf,
+
+        /// Stop recording after this many seconds instead of waiting for Enter
+        #[arg(long, value_name = "SECS")]
+        duration: Option<u64>,
+
+        /// Samples per second
+        #[arg(long, short = 'F', default_value_t = 999)]
+        frequency: u32,
+
+        /// How perf unwinds stacks
+        #[arg(
+            long,
+            default_value = "fp",
+            value_parser = PossibleValuesParser::new(["fp", "dwarf", "lbr"])
+        )]
+        call_graph: String,
+
+        /// How many threads and frames to list
+        #[arg(long, default_value_t = 15)]
+        top: usize,
+
+        /// Additional arguments to pass to the target application
+        #[arg(trailing_var_arg = true, allow_hyphen_values = true)]
+        args: Vec<String>,
+    },
+}
+
+#[derive(Args)]
+struct LaunchArgs {
     /// Path to the target Tauri application binary
-    target: PathBuf,
+    #[arg(required = true)]
+    target: Option<PathBuf>,
 
     /// Automatically open the inspector on launch
     #[arg(long)]
     auto_open: bool,
 
+    /// Record libspy telemetry to this JSON-lines file
+    #[arg(long, value_name = "FILE")]
+    report: Option<PathBuf>,
+
+    /// Enable an opt-in probe (repeatable or comma-separated)
+    #[arg(
+        long = "probe",
+        value_name = "NAME",
+        value_delimiter = ',',
+        value_parser = PossibleValuesParser::new(PROBES),
+        requires = "report"
+    )]
+    probes: Vec<String>,
+
     /// Additional arguments to pass to the target application
     #[arg(trailing_var_arg = true, allow_hyphen_values = true)]
     args: Vec<String>,
@@ -114,14 +277,101 @@ fn check_webkit_available() -> bool {
         .unwrap_or(false)
 }
 
+/// Wait for Enter, `duration` seconds or the target's exit, whichever comes
+/// first. Returns the target's exit status if it exited.
+fn wait_for_scenario(child: &mut Child, duration: Option<u64>) -> Option<ExitStatus> {
+    let (enter, pressed) = mpsc::channel();
+    if duration.is_none() {
+        thread::spawn(move || {
+            let mut line = String::new();
+            let _ = std::io::stdin().lock().read_line(&mut line);
+            let _ = enter.send(());
+        });
+    }
+    let deadline = duration.map(|secs| Instant::now() + Duration::from_secs(secs));
+
+    loop {
+        if let Ok(Some(status)) = child.try_wait() {
+            return Some(status);
+        }
+        if deadline.is_some_and(|d| Instant::now() >= d) {
+            return None;
+        }
+        if pressed.recv_timeout(Duration::from_millis(200)).is_ok() {
+            return None;
+        }
+    }
+}
+
 fn main() -> ExitCode {
     let cli = Cli::parse();
 
-    // Validate target binary
-    if let Err(e) = validate_target(&cli.target) {
-        eprintln!("{} {}", "error:".red().bold(), e);
-        return ExitCode::FAILURE;
+    let result = match cli.command {
+        Some(Commands::Report {
+            file,
+            flamegraph,
+            source_maps,
+        }) => report::run(&file, flamegraph.as_deref(), source_maps.as_deref()),
+        Some(Commands::Coverage {
+            target,
+            duration,
+            port,
+            source_maps,
+            top,
+            args,
+        }) => spy_command(&target, &args, false).and_then(|command| {
+            let options = coverage::Options {
+                port,
+                duration,
+                source_maps,
+                top,
+            };
+            coverage::run(command, &options)
+        }),
+        Some(Commands::Startup {
+            target,
+            settle,
+            port,
+            args,
+        }) => spy_command(&target, &args, false).and_then(|command| {
+            startup::run(command, &startup::Options { port, settle })
+        }),
+        Some(Commands::PerfRecord {
+            target,
+            output,
+            duration,
+            frequency,
+            call_graph,
+            top,
+            args,
+        }) => spy_command(&target, &args, false).and_then(|command| {
+            let options = perf::Options {
+                output,
+                duration,
+                frequency,
+                call_graph,
+                top,
+            };
+            perf::run(command, &options)
+        }),
+        None => return launch(cli.launch),
+    };
+
+    match result {
+        Ok(()) => ExitCode::SUCCESS,
+        Err(e) => {
+            eprintln!("{} {}", "error:".red().bold(), e);
+            ExitCode::FAILURE
+        }
     }
+}
+
+/// Validate the target and build the command that runs it with libspy
+/// preloaded; shared by the launcher and the coverage, startup and
+/// perf-record subcommands
+fn spy_command(target: &Path, args: &[String], auto_open: bool) -> Result<Command, String> {
+    // Validate target binary
+    validate_target(target)?;
 
     // Check WebKitGTK availability
     if !check_webkit_available() {
@@ -141,18 +391,12 @@ fn main() -> ExitCode {
     }
 
     // Find the injection library
-    let libspy_path = match find_libspy() {
-        Ok(path) => path,
-        Err(e) => {
-            eprintln!("{} {}", "error:".red().bold(), e);
-            return ExitCode::FAILURE;
-        }
-    };
+    let libspy_path = find_libspy()?;
 
     println!(
         "{} Launching {} with DevTools enabled",
         "tauri-spy".cyan().bold(),
-        cli.target.display().to_string().green()
+        target.display().to_string().green()
     );
     println!(
         "{} Injecting {}",
@@ -169,18 +413,60 @@ fn main() -> ExitCode {
     }
 
     // Set auto-open environment variable for the injection library
-    let auto_open = if cli.auto_open { "1" } else { "0" };
+    let auto_open = if auto_open { "1" } else { "0" };
 
     // Launch target with LD_PRELOAD and WebKit rendering workarounds
-    let status = Command::new(&cli.target)
-        .args(&cli.args)
+    let mut command = Command::new(target);
+    command
+        .args(args)
         .env("LD_PRELOAD", &preload)
         .env("TAURI_SPY_AUTO_OPEN", auto_open)
         // Work around WebKitGTK GPU rendering issues (blank/black window)
         // See: https://github.com/nicbarker/clay/issues/213
         .env("WEBKIT_DISABLE_COMPOSITING_MODE", "1")
-        .env("WEBKIT_DISABLE_DMABUF_RENDERER", "1")
-        .status();
+        .env("WEBKIT_DISABLE_DMABUF_RENDERER", "1");
+    Ok(command)
+}
+
+fn launch(cli: LaunchArgs) -> ExitCode {
+    // Required by clap whenever no subcommand is given
+    let target = cli.target.expect("target is required");
+
+    let mut command = match spy_command(&target, &cli.args, cli.auto_open) {
+        Ok(command) => command,
+        Err(e) => {
+            eprintln!("{} {}", "error:".red().bold(), e);
+            return ExitCode::FAILURE;
+        }
+    };
+
+    // Telemetry report for libspy's recorder
+    if let Some(report) = &cli.report {
+        println!(
+            "{} Recording telemetry to {}",
+            "       >>>".cyan(),
+            report.display().to_string().dimmed()
+        );
+        command.env("TAURI_SPY_REPORT", report);
+    }
+    if !cli.probes.is_empty() {
+        println!(
+            "{} Probes: {}",
+            "       >>>".cyan(),
+            cli.probes.join(", ").dimmed()
+        );
+        command.env("TAURI_SPY_PROBES", cli.probes.join(","));
+    }
+
+    let status = command.status();
+
+    if let Some(report) = &cli.report {
+        println!(
+            "{} Summarize with: {}",
+            "note:".cyan().bold(),
+            format!("tauri-spy report {}", report.display()).dimmed()
+        );
+    }
 
     match status {
         Ok(status) => {
@@ -0,0 +1,366 @@
+//! `tauri-spy perf-record` — one CPU profile across Rust, WebKit and JS
+//!
+//! The target runs under `perf record`, which follows it into the web and
+//! network processes WebKit spawns. `JSC_logJITCodeForPerf=1` (inherited by
+//! the web process) makes JavaScriptCore write a jitdump for the code it
+//! generates, and `perf inject --jit` turns that into symbols, so JIT'ed JS
+//! functions show up by name instead of as anonymous addresses.
+//!
+//! The samples are folded into one stack per line for flamegraph.pl, inferno
+//! or speedscope, rooted at the thread name. Frames from JIT'ed code carry
+//! the `_[j]` suffix and kernel frames `_[k]`, which `flamegraph.pl
+//! --color=java` colours apart. The perf data files are kept next to the
+//! output for `perf report`.
+
+use crate::report::heading;
+use crate::wait_for_scenario;
+use colored::Colorize;
+use std::collections::{BTreeMap, HashMap};
+use std::fs;
+use std::path::{Path, PathBuf};
+use std::process::{Command, Stdio};
+
+/// Share of samples at or above which JS frames were expected but missing
+const MIN_JIT_SHARE: f64 = 0.001;
+
+pub struct Options {
+    pub output: PathBuf,
+    pub duration: Option<u64>,
+    pub frequency: u32,
+    pub call_graph: String,
+    pub top: usize,
+}
+
+#[derive(Default)]
+struct Profile {
+    stacks: BTreeMap<String, u64>,
+    /// Leaf frame → samples
+    self_samples: HashMap<String, u64>,
+    /// Thread name → samples
+    threads: HashMap<String, u64>,
+    samples: u64,
+    jit_samples: u64,
+    shallow_samples: u64,
+}
+
+/// Check that perf runs and the kernel lets it sample user space
+fn check_perf() -> Result<(), String> {
+    let version = Command::new("perf")
+        .arg("--version")
+        .stdout(Stdio::null())
+        .stderr(Stdio::null())
+        .status();
+    if !version.is_ok_and(|s| s.success()) {
+        return Err("perf not found (Debian: linux-perf, Ubuntu: linux-tools-generic)".to_string());
+    }
+
+    let paranoid = fs::read_to_string("/proc/sys/kernel/perf_event_paranoid")
+        .ok()
+        .and_then(|s| s.trim().parse::<i32>().ok());
+    if paranoid.is_some_and(|level| level > 2) {
+        eprintln!(
+            "{} kernel.perf_event_paranoid is {}; perf may be refused",
+            "warning:".yellow().bold(),
+            paranoid.unwrap_or_default()
+        );
+        eprintln!("  hint: sudo sysctl kernel.perf_event_paranoid=2");
+    }
+    Ok(())
+}
+
+/// One frame of `perf script -F comm,ip,sym,dso` output, as it goes in a
+/// folded stack, and whether it is JIT'ed code
+fn frame(line: &str) -> (String, bool) {
+    let rest = line.trim().split_once(' ').map_or("", |(_, rest)| rest);
+    let (symbol, dso) = match rest.rsplit_once(" (") {
+        Some((symbol, dso)) => (symbol.trim(), dso.trim_end_matches(')')),
+        None => (rest.trim(), ""),
+    };
+    let library = Path::new(dso)
+        .file_name()
+        .and_then(|n| n.to_str())
+        .unwrap_or(dso)
+        .trim_matches(|c| c == '[' || c == ']');
+
+    let jit = library.starts_with("jitted-");
+    let name = if symbol.is_empty() || symbol == "[unknown]" {
+        let library = if library.is_empty() {
+            "unknown"
+        } else {
+            library
+        };
+        format!("[{}]", library)
+    } else {
+        symbol.replace(';', ":")
+    };
+    let name = if jit {
+        format!("{}_[j]", name)
+    } else if dso.starts_with("[kernel") {
+        format!("{}_[k]", name)
+    } else {
+        name
+    };
+    (name, jit)
+}
+
+/// Fold `perf script` output. Samples are separated by blank lines; each
+/// starts with the thread name and lists its frames leaf first.
+fn fold(script: &str) -> Profile {
+    let mut profile = Profile::default();
+    let mut thread = String::new();
+    let mut frames: Vec<(String, bool)> = Vec::new();
+
+    let mut finish = |thread: &str, frames: &mut Vec<(String, bool)>| {
+        if thread.is_empty() && frames.is_empty() {
+            return;
+        }
+        profile.samples += 1;
+        *profile.threads.entry(thread.to_string()).or_default() += 1;
+        if frames.iter().any(|(_, jit)| *jit) {
+            profile.jit_samples += 1;
+        }
+        if frames.len() <= 1 {
+            profile.shallow_samples += 1;
+        }
+        if let Some((leaf, _)) = frames.first() {
+            *profile.self_samples.entry(leaf.clone()).or_default() += 1;
+        }
+        let mut stack = thread.replace(';', ":");
+        for (name, _) in frames.iter().rev() {
+            stack.push(';');
+            stack.push_str(name);
+        }
+        *profile.stacks.entry(stack).or_default() += 1;
+        frames.clear();
+    };
+
+    for line in script.lines() {
+        if line.trim().is_empty() {
+            finish(&thread, &mut frames);
+            thread.clear();
+        } else if line.starts_with(char::is_whitespace) {
+            frames.push(frame(line));
+        } else {
+            finish(&thread, &mut frames);
+            thread = line.trim().to_string();
+        }
+    }
+    finish(&thread, &mut frames);
+    profile
+}
+
+fn write_folded(profile: &Profile, out: &Path) -> Result<(), String> {
+    let mut contents = String::new();
+    for (stack, count) in &profile.stacks {
+        contents.push_str(&format!("{} {}\n", stack, count));
+    }
+    fs::write(out, contents)
+        .map_err(|e| format!("Failed to write flamegraph {}: {}", out.display(), e))
+}
+
+fn print(profile: &Profile, top: usize) {
+    heading("CPU profile");
+    let share = |n: u64| n as f64 * 100.0 / profile.samples.max(1) as f64;
+    println!(
+        "  {} sample(s), {:.1}% with JIT'ed JS on the stack",
+        profile.samples,
+        share(profile.jit_samples)
+    );
+
+    let mut threads: Vec<(&String, &u64)> = profile.threads.iter().collect();
+    threads.sort_by(|a, b| b.1.cmp(a.1).then_with(|| a.0.cmp(b.0)));
+    println!("  busiest threads:");
+    for (thread, samples) in threads.into_iter().take(top) {
+        println!("    {:>6.1}%  {}", share(*samples), thread);
+    }
+
+    let mut leaves: Vec<(&String, &u64)> = profile.self_samples.iter().collect();
+    leaves.sort_by(|a, b| b.1.cmp(a.1).then_with(|| a.0.cmp(b.0)));
+    println!("  hottest frames (self):");
+    for (frame, samples) in leaves.into_iter().take(top) {
+        println!("    {:>6.1}%  {}", share(*samples), frame);
+    }
+
+    if profile.samples > 0 && share(profile.jit_samples) < MIN_JIT_SHARE * 100.0 {
+        println!(
+            "  {} no JIT'ed JS frames were resolved; JSC may not have written its jitdump",
+            "warning:".yellow().bold()
+        );
+        println!(
+            "  {} a sandboxed web process writes it to a private /tmp",
+            "note:".cyan().bold()
+        );
+    }
+    if share(profile.shallow_samples) >= 50.0 {
+        println!(
+            "  {} most stacks are one frame deep; try --call-graph dwarf",
+            "note:".cyan().bold()
+        );
+    }
+}
+
+pub fn run(command: Command, options: &Options) -> Result<(), String> {
+    check_perf()?;
+    let data = options.output.with_extension("perf.data");
+    let jit_data = options.output.with_extension("jit.data");
+
+    // The launcher's command, run under perf with the same environment.
+    // -k 1 uses the monotonic clock jitdump records are stamped with.
+    let mut perf = Command::new("perf");
+    perf.arg("record")
+        .arg("--call-graph")
+        .arg(&options.call_graph)
+        .args(["-k", "1", "-F"])
+        .arg(options.frequency.to_string())
+        .arg("-o")
+        .arg(&data)
+        .arg("--")
+        .arg(command.get_program())
+        .args(command.get_args())
+        .env("JSC_logJITCodeForPerf", "1");
+    for (key, value) in command.get_envs() {
+        match value {
+            Some(value) => perf.env(key, value),
+            None => perf.env_remove(key),
+        };
+    }
+    println!(
+        "{} JIT code logging on, perf data in {}",
+        "       >>>".cyan(),
+        data.display().to_string().dimmed()
+    );
+
+    let mut child = perf
+        .spawn()
+        .map_err(|e| format!("Failed to launch perf: {}", e))?;
+    match options.duration {
+        Some(secs) => println!("{} Recording for {} s", "       >>>".cyan(), secs),
+        None => println!(
+            "{} Run your scenario, then press Enter (or quit the app) to stop recording",
+            "       >>>".cyan()
+        ),
+    }
+    if wait_for_scenario(&mut child, options.duration).is_none() {
+        // perf writes its data and stops the target on SIGINT; killing it
+        // outright would leave a truncated file
+        let _ = Command::new("kill")
+            .args(["-INT", &child.id().to_string()])
+            .status();
+    }
+    let _ = child.wait();
+    if !data.exists() {
+        return Err("perf recorded nothing".to_string());
+    }
+
+    println!("{} Resolving JIT'ed code", "       >>>".cyan());
+    let injected = Command::new("perf")
+        .args(["inject", "--jit", "-i"])
+        .arg(&data)
+        .arg("-o")
+        .arg(&jit_data)
+        .status()
+        .map_err(|e| format!("Failed to run perf inject: {}", e))?;
+    let input = if injected.success() { &jit_data } else { &data };
+
+    let script = Command::new("perf")
+        .args(["script", "-F", "comm,ip,sym,dso", "-i"])
+        .arg(input)
+        .stderr(Stdio::null())
+        .output()
+        .map_err(|e| format!("Failed to run perf script: {}", e))?;
+    if !script.status.success() {
+        return Err(format!("perf script failed on {}", input.display()));
+    }
+
+    let profile = fold(&String::from_utf8_lossy(&script.stdout));
+    write_folded(&profile, &options.output)?;
+    print(&profile, options.top);
+
+    println!();
+    println!(
+        "{} Wrote {} stack(s) to {}; perf data in {}",
+        "note:".cyan().bold(),
+        profile.stacks.len(),
+        options.output.display(),
+        input.display()
+    );
+    Ok(())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// `perf script -F comm,ip,sym,dso` output: a JS sample running JIT'ed
+    /// code, a kernel sample, and a one-frame sample of unknown code
+    const SCRIPT: &str = "\
+WebKitWebProces 
+\t    7f1200001000 fetchRows#Bk9x:[Baseline] (/tmp/jitted-4242-17.so)
+\t    7f3400002000 vmEntryToJavaScript (/usr/lib/libjavascriptcoregtk-4.1.so.0)
+\t    7f3400003000 g_main_context_iteration (/usr/lib/libglib-2.0.so.0.8000.0)
+
+app;main 
+\tffffffff81000000 __schedule ([kernel.kallsyms])
+\t    7f5600004000 [unknown] (/usr/lib/libc.so.6)
+
+WebKitWebProces 
+\t    7f7800005000 [unknown] ([unknown])
+";
+
+    #[test]
+    fn names_frames() {
+        assert_eq!(
+            frame("    7f1200001000 fetchRows#Bk9x:[Baseline] (/tmp/jitted-4242-17.so)"),
+            ("fetchRows#Bk9x:[Baseline]_[j]".to_string(), true)
+        );
+        assert_eq!(
+            frame("ffffffff81000000 __schedule ([kernel.kallsyms])"),
+            ("__schedule_[k]".to_string(), false)
+        );
+        assert_eq!(
+            frame("    7f5600004000 [unknown] (/usr/lib/libc.so.6)"),
+            ("[libc.so.6]".to_string(), false)
+        );
+        assert_eq!(
+            frame("    7f7800005000 [unknown] ([unknown])"),
+            ("[unknown]".to_string(), false)
+        );
+        assert_eq!(frame("    7f7800005000"), ("[unknown]".to_string(), false));
+        // ';' separates frames in a folded stack
+        assert_eq!(
+            frame("    7f3400006000 run;later(int) (/usr/lib/libapp.so)"),
+            ("run:later(int)".to_string(), false)
+        );
+    }
+
+    #[test]
+    fn folds_samples() {
+        let profile = fold(SCRIPT);
+        assert_eq!(profile.samples, 3);
+        assert_eq!(profile.jit_samples, 1);
+        assert_eq!(profile.shallow_samples, 1);
+        assert_eq!(profile.threads["WebKitWebProces"], 2);
+        assert_eq!(profile.threads["app;main"], 1);
+        assert_eq!(profile.self_samples["fetchRows#Bk9x:[Baseline]_[j]"], 1);
+        assert_eq!(profile.self_samples["__schedule_[k]"], 1);
+        assert_eq!(profile.self_samples["[unknown]"], 1);
+
+        let stacks: Vec<(&str, u64)> = profile
+            .stacks
+            .iter()
+            .map(|(stack, n)| (stack.as_str(), *n))
+            .collect();
+        assert_eq!(
+            stacks,
+            vec![
+                ("WebKitWebProces;[unknown]", 1),
+                (
+                    "WebKitWebProces;g_main_context_iteration;vmEntryToJavaScript;\
+                     fetchRows#Bk9x:[Baseline]_[j]",
+                    1
+                ),
+                ("app:main;[libc.so.6];__schedule_[k]", 1),
+            ]
+        );
+    }
+}
@@ -0,0 +1,157 @@
+//! `animations` and `will_change` records — animations the compositor can't
+//! run alone, and oversized layers
+//!
+//! Each `animations` record covers one second with
+//! `[selector, type, name, properties, trigger, frames, dropped, max_frame_ms]`
+//! rows, `trigger` being "layout" or "paint". A `will_change` record is the
+//! page's current set of promoted layers as
+//! `[selector, will-change, width, height, bytes]`.
+
+use super::{bytes, heading, num, webview_of, Report};
+use colored::Colorize;
+use serde_json::Value;
+use std::collections::{BTreeMap, HashMap};
+
+/// A single will-change layer this large is worth a look
+const LAYER_LIMIT: f64 = 16.0 * 1024.0 * 1024.0;
+
+/// How many animations and layers to list per webview
+const TOP_ANIMATIONS: usize = 10;
+const TOP_LAYERS: usize = 10;
+
+#[derive(Default)]
+struct Animation {
+    trigger: String,
+    properties: String,
+    frames: f64,
+    dropped: f64,
+    max_frame_ms: f64,
+}
+
+#[derive(Default)]
+struct Webview {
+    frames: f64,
+    dropped: f64,
+    animations: HashMap<(String, String, String), Animation>,
+    layers: Option<Value>,
+}
+
+fn cell(row: &[Value], i: usize) -> f64 {
+    row.get(i).and_then(Value::as_f64).unwrap_or(0.0)
+}
+
+fn string(row: &[Value], i: usize) -> String {
+    row.get(i).and_then(Value::as_str).unwrap_or("").to_string()
+}
+
+fn percent(part: f64, whole: f64) -> f64 {
+    if whole > 0.0 {
+        part * 100.0 / whole
+    } else {
+        0.0
+    }
+}
+
+pub fn print(report: &Report) {
+    let mut webviews: BTreeMap<i64, Webview> = BTreeMap::new();
+    for r in report.of_kind("animations") {
+        let w = webviews.entry(webview_of(r)).or_default();
+        w.frames += num(r, "frames");
+        w.dropped += num(r, "dropped");
+
+        let rows = r.get("items").and_then(Value::as_array);
+        for row in rows.into_iter().flatten().filter_map(Value::as_array) {
+            let key = (string(row, 0), string(row, 1), string(row, 2));
+            let a = w.animations.entry(key).or_default();
+            a.properties = string(row, 3);
+            a.trigger = string(row, 4);
+            a.frames += cell(row, 5);
+            a.dropped += cell(row, 6);
+            a.max_frame_ms = a.max_frame_ms.max(cell(row, 7));
+        }
+    }
+    for r in report.of_kind("will_change") {
+        webviews.entry(webview_of(r)).or_default().layers = Some(r.clone());
+    }
+    if webviews.is_empty() {
+        return;
+    }
+
+    heading("Animations and layers");
+    for (webview, w) in webviews {
+        println!("  webview {}:", webview);
+
+        if !w.animations.is_empty() {
+            println!(
+                "    {} frame(s) ran a layout or paint animation, {:.1}% dropped",
+                w.frames,
+                percent(w.dropped, w.frames)
+            );
+            let mut animations: Vec<_> = w.animations.into_iter().collect();
+            animations.sort_by(|a, b| b.1.frames.total_cmp(&a.1.frames));
+            println!(
+                "    {:>7} {:>8} {:>8} {:>8}  animation",
+                "trigger", "frames", "dropped", "max ms"
+            );
+            for ((selector, kind, name), a) in animations.iter().take(TOP_ANIMATIONS) {
+                println!(
+                    "    {:>7} {:>8} {:>7.1}% {:>8.1}  {} {} \"{}\" ({})",
+                    a.trigger,
+                    a.frames,
+                    percent(a.dropped, a.frames),
+                    a.max_frame_ms,
+                    selector,
+                    kind,
+                    name,
+                    a.properties
+                );
+            }
+            let layout = animations
+                .iter()
+                .filter(|(_, a)| a.trigger == "layout")
+                .count();
+            if layout > 0 {
+                println!(
+                    "    {} {} animation(s) re-run layout every frame; animate transform or opacity instead",
+                    "warning:".yellow().bold(),
+                    layout
+                );
+            }
+        }
+
+        if let Some(layers) = &w.layers {
+            println!(
+                "    {} will-change layer(s) holding about {}",
+                num(layers, "layers"),
+                bytes(num(layers, "bytes"))
+            );
+            let rows = layers.get("items").and_then(Value::as_array);
+            let rows: Vec<&Vec<Value>> = rows
+                .into_iter()
+                .flatten()
+                .filter_map(Value::as_array)
+                .collect();
+            for row in rows.iter().take(TOP_LAYERS) {
+                println!(
+                    "    {:>9} {:>11}  {} (will-change: {})",
+                    bytes(cell(row, 4)),
+                    format!("{}x{}", cell(row, 2), cell(row, 3)),
+                    string(row, 0),
+                    string(row, 1)
+                );
+            }
+            let huge = rows
+                .iter()
+                .filter(|row| cell(row, 4) >= LAYER_LIMIT)
+                .count();
+            if huge > 0 {
+                println!(
+                    "    {} {} layer(s) of {} or more; set will-change only while animating",
+                    "note:".cyan().bold(),
+                    huge,
+                    bytes(LAYER_LIMIT)
+                );
+            }
+        }
+    }
+}
@@ -0,0 +1,175 @@
+//! `canvas` and `canvas_expensive` records — Canvas 2D drawing cost
+//!
+//! Each `canvas` record covers one second with an entry per canvas that was
+//! drawn to: calls, frames, the busiest frame, estimated time (sampled), the
+//! top `[method, calls, ms]` and the always-timed expensive operations. A
+//! `canvas_expensive` is the first getImageData(), shadowed draw or heavily
+//! scaled drawImage() from a call site, with its stack.
+
+use super::{heading, num, text, webview_of, Report};
+use colored::Colorize;
+use serde_json::Value;
+use std::collections::{BTreeMap, HashMap};
+
+/// Canvas time per frame that leaves too little of a 60 Hz frame
+const BUSY_FRAME_MS: f64 = 1000.0 / 60.0 / 2.0;
+
+/// How many methods and expensive call sites to list per canvas
+const TOP_METHODS: usize = 5;
+const TOP_SITES: usize = 5;
+const STACK_FRAMES: usize = 3;
+
+#[derive(Default)]
+struct Canvas {
+    label: String,
+    size: (f64, f64),
+    seconds: f64,
+    calls: f64,
+    frames: f64,
+    max_per_frame: f64,
+    ms: f64,
+    methods: HashMap<String, (f64, f64)>,
+    get_image_data: (f64, f64, f64),
+    shadow: (f64, f64),
+    scaled: (f64, f64, f64),
+    sites: Vec<(String, String, f64, String, Vec<String>)>,
+}
+
+fn triple(record: &Value, field: &str) -> (f64, f64, f64) {
+    let cell = |i: usize| {
+        record
+            .get(field)
+            .and_then(|v| v.get(i))
+            .and_then(Value::as_f64)
+            .unwrap_or(0.0)
+    };
+    (cell(0), cell(1), cell(2))
+}
+
+pub fn print(report: &Report) {
+    let mut webviews: BTreeMap<i64, BTreeMap<i64, Canvas>> = BTreeMap::new();
+    for r in report.of_kind("canvas") {
+        let w = webviews.entry(webview_of(r)).or_default();
+        let entries = r.get("canvases").and_then(Value::as_array);
+        for e in entries.into_iter().flatten() {
+            let c = w.entry(num(e, "canvas") as i64).or_default();
+            c.label = text(e, "label").to_string();
+            c.size = (num(e, "width"), num(e, "height"));
+            c.seconds += 1.0;
+            c.calls += num(e, "calls");
+            c.frames += num(e, "frames");
+            c.max_per_frame = c.max_per_frame.max(num(e, "max_per_frame"));
+            c.ms += num(e, "ms");
+
+            let methods = e.get("methods").and_then(Value::as_array);
+            for m in methods.into_iter().flatten().filter_map(Value::as_array) {
+                let name = m.first().and_then(Value::as_str).unwrap_or("?");
+                let cell = |i: usize| m.get(i).and_then(Value::as_f64).unwrap_or(0.0);
+                let entry = c.methods.entry(name.to_string()).or_default();
+                entry.0 += cell(1);
+                entry.1 += cell(2);
+            }
+
+            let (n, ms, pixels) = triple(e, "get_image_data");
+            c.get_image_data.0 += n;
+            c.get_image_data.1 += ms;
+            c.get_image_data.2 += pixels;
+            let (n, ms, _) = triple(e, "shadow");
+            c.shadow.0 += n;
+            c.shadow.1 += ms;
+            let (n, ms, ratio) = triple(e, "scaled");
+            c.scaled.0 += n;
+            c.scaled.1 += ms;
+            c.scaled.2 = c.scaled.2.max(ratio);
+        }
+    }
+    if webviews.is_empty() {
+        return;
+    }
+
+    for r in report.of_kind("canvas_expensive") {
+        let w = webviews.entry(webview_of(r)).or_default();
+        let c = w.entry(num(r, "canvas") as i64).or_default();
+        let stack = r.get("stack").and_then(Value::as_array);
+        c.sites.push((
+            text(r, "op").to_string(),
+            text(r, "detail").to_string(),
+            num(r, "ms"),
+            text(r, "site").to_string(),
+            stack
+                .into_iter()
+                .flatten()
+                .filter_map(Value::as_str)
+                .map(str::to_string)
+                .collect(),
+        ));
+    }
+
+    heading("Canvas 2D");
+    for (webview, canvases) in webviews {
+        println!("  webview {}:", webview);
+        for (id, c) in canvases {
+            if c.seconds == 0.0 {
+                continue;
+            }
+            println!(
+                "    canvas {} {} ({}x{}): {:.0} calls/s over {} frame(s), {:.0} calls/frame (max {}), ~{:.1} ms/s",
+                id,
+                c.label,
+                c.size.0,
+                c.size.1,
+                c.calls / c.seconds,
+                c.frames,
+                c.calls / c.frames.max(1.0),
+                c.max_per_frame,
+                c.ms / c.seconds
+            );
+
+            let mut methods: Vec<_> = c.methods.iter().collect();
+            methods.sort_by(|a, b| b.1 .1.total_cmp(&a.1 .1));
+            for (name, (calls, ms)) in methods.iter().take(TOP_METHODS) {
+                println!("      {:>10} calls {:>9.1} ms  {}", calls, ms, name);
+            }
+
+            if c.get_image_data.0 > 0.0 {
+                println!(
+                    "      {} getImageData() read back {:.1} Mpx in {} call(s), {:.1} ms",
+                    "warning:".yellow().bold(),
+                    c.get_image_data.2 / 1e6,
+                    c.get_image_data.0,
+                    c.get_image_data.1
+                );
+            }
+            if c.shadow.0 > 0.0 {
+                println!(
+                    "      {} {} draw(s) with shadowBlur, {:.1} ms; each blurs on the CPU without a GPU",
+                    "note:".cyan().bold(),
+                    c.shadow.0,
+                    c.shadow.1
+                );
+            }
+            if c.scaled.0 > 0.0 {
+                println!(
+                    "      {} {} drawImage() call(s) scaled up to {}x, {:.1} ms; pre-scale the source once",
+                    "note:".cyan().bold(),
+                    c.scaled.0,
+                    c.scaled.2,
+                    c.scaled.1
+                );
+            }
+            for (op, detail, ms, site, stack) in c.sites.iter().take(TOP_SITES) {
+                println!("      {} ({}) {:.2} ms {}", op, detail, ms, site);
+                for frame in stack.iter().skip(1).take(STACK_FRAMES) {
+                    println!("           {}", frame);
+                }
+            }
+            if c.frames > 0.0 && c.ms / c.frames >= BUSY_FRAME_MS {
+                println!(
+                    "      {} drawing takes {:.1} ms per frame, over half the frame budget",
+                    "warning:".yellow().bold(),
+                    c.ms / c.frames
+                );
+            }
+        }
+    }
+}
@@ -0,0 +1,125 @@
+//! `component_renders` records — framework component renders
+//!
+//! Each record covers one second of one framework's commits in one webview.
+//! Components are keyed by their `;`-separated path from the root, which is
+//! also the folded-stack format flamegraph tools read, so `--flamegraph`
+//! writes the paths out nearly as-is.
+
+use super::{heading, num, text, webview_of, Report};
+use colored::Colorize;
+use serde_json::Value;
+use std::collections::{BTreeMap, HashMap};
+use std::fs;
+use std::path::Path;
+
+/// How many components to list per framework
+const TOP_COMPONENTS: usize = 10;
+
+#[derive(Default)]
+struct Framework {
+    commits: f64,
+    timed: bool,
+    /// path -> (renders, self ms)
+    stacks: HashMap<String, (f64, f64)>,
+}
+
+fn collect(report: &Report) -> BTreeMap<(i64, String), Framework> {
+    let mut frameworks: BTreeMap<(i64, String), Framework> = BTreeMap::new();
+    for r in report.of_kind("component_renders") {
+        let key = (webview_of(r), text(r, "framework").to_string());
+        let f = frameworks.entry(key).or_default();
+        f.commits += num(r, "commits");
+        f.timed |= r.get("timed").and_then(Value::as_bool).unwrap_or(false);
+
+        let stacks = r.get("stacks").and_then(Value::as_array);
+        for stack in stacks.into_iter().flatten() {
+            let Some(path) = stack.get(0).and_then(Value::as_str) else {
+                continue;
+            };
+            let entry = f.stacks.entry(path.to_string()).or_default();
+            entry.0 += stack.get(1).and_then(Value::as_f64).unwrap_or(0.0);
+            entry.1 += stack.get(2).and_then(Value::as_f64).unwrap_or(0.0);
+        }
+    }
+    frameworks
+}
+
+pub fn print(report: &Report) {
+    let frameworks = collect(report);
+    let notes = report.of_kind("component_hooks").count();
+    if frameworks.is_empty() && notes == 0 {
+        return;
+    }
+
+    heading("Component renders");
+    if notes > 0 {
+        println!(
+            "  {} a framework devtools hook was already defined in {} document(s); left it alone",
+            "note:".cyan().bold(),
+            notes
+        );
+    }
+
+    for ((webview, framework), f) in frameworks {
+        let renders: f64 = f.stacks.values().map(|s| s.0).sum();
+        print!("  webview {} {}: {} render(s)", webview, framework, renders);
+        if f.commits > 0.0 {
+            print!(" in {} commit(s)", f.commits);
+        }
+        println!();
+
+        // Leaf component names, wherever they appear in the tree
+        let mut components: HashMap<&str, (f64, f64)> = HashMap::new();
+        for (path, (count, ms)) in &f.stacks {
+            let name = path.rsplit(';').next().unwrap_or(path);
+            let c = components.entry(name).or_default();
+            c.0 += count;
+            c.1 += ms;
+        }
+        let mut components: Vec<(&str, (f64, f64))> = components.into_iter().collect();
+        components.sort_by(|a, b| b.1 .0.total_cmp(&a.1 .0));
+        for (name, (count, ms)) in components.iter().take(TOP_COMPONENTS) {
+            if f.timed {
+                println!("    {:>8} renders {:>10.2} ms self  {}", count, ms, name);
+            } else {
+                println!("    {:>8} renders  {}", count, name);
+            }
+        }
+        if !f.timed && framework == "react" {
+            println!(
+                "    {} production React reports counts only; use a profiling build for self time",
+                "note:".cyan().bold()
+            );
+        }
+    }
+}
+
+/// Write folded stacks for flamegraph.pl, inferno or speedscope. Weights are
+/// self time in microseconds where the framework reported it, render counts
+/// otherwise.
+pub fn write_flamegraph(report: &Report, out: &Path) -> Result<usize, String> {
+    let mut lines = Vec::new();
+    for ((webview, framework), f) in collect(report) {
+        let mut stacks: Vec<(&String, &(f64, f64))> = f.stacks.iter().collect();
+        stacks.sort_by(|a, b| a.0.cmp(b.0));
+        for (path, (count, ms)) in stacks {
+            let weight = if f.timed {
+                (ms * 1000.0).round() as u64
+            } else {
+                *count as u64
+            };
+            if weight > 0 {
+                lines.push(format!(
+                    "webview {};{};{} {}",
+                    webview, framework, path, weight
+                ));
+            }
+        }
+    }
+
+    let mut contents = lines.join("\n");
+    contents.push('\n');
+    fs::write(out, contents)
+        .map_err(|e| format!("Failed to write flamegraph {}: {}", out.display(), e))?;
+    Ok(lines.len())
+}
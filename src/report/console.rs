@@ -0,0 +1,154 @@
+//! `console`, `console_file` and `console_rotated` records — console
+//! logging volume
+//!
+//! Each `console` record covers one second: calls, characters of formatted
+//! text, time spent in the console methods, lines not written to the console
+//! file, and `[site, level, calls, chars, ms]` rows. The text itself is in
+//! the per-webview files named by `console_file`.
+
+use super::{heading, num, text, webview_of, Report};
+use colored::Colorize;
+use serde_json::Value;
+use std::collections::{BTreeMap, HashMap};
+
+/// Calls or characters in one second that make a logging storm
+const STORM_CALLS: f64 = 500.0;
+const STORM_CHARS: f64 = 256.0 * 1024.0;
+
+/// How many call sites to list per webview
+const TOP_SITES: usize = 10;
+const STACK_FRAMES: usize = 3;
+
+#[derive(Default)]
+struct Site {
+    calls: f64,
+    chars: f64,
+    ms: f64,
+}
+
+#[derive(Default)]
+struct Webview {
+    seconds: f64,
+    calls: f64,
+    chars: f64,
+    ms: f64,
+    dropped: f64,
+    storms: f64,
+    worst: (f64, f64),
+    sites: HashMap<(String, String), Site>,
+    stacks: HashMap<String, Vec<String>>,
+    file: Option<String>,
+    rotations: f64,
+}
+
+pub fn print(report: &Report) {
+    let mut webviews: BTreeMap<i64, Webview> = BTreeMap::new();
+    for r in report.of_kind("console") {
+        let w = webviews.entry(webview_of(r)).or_default();
+        let (calls, chars) = (num(r, "calls"), num(r, "chars"));
+        w.seconds += 1.0;
+        w.calls += calls;
+        w.chars += chars;
+        w.ms += num(r, "ms");
+        w.dropped += num(r, "dropped");
+        if calls >= STORM_CALLS || chars >= STORM_CHARS {
+            w.storms += 1.0;
+        }
+        w.worst.0 = w.worst.0.max(calls);
+        w.worst.1 = w.worst.1.max(chars);
+
+        let rows = r.get("sites").and_then(Value::as_array);
+        for row in rows.into_iter().flatten().filter_map(Value::as_array) {
+            let cell = |i: usize| row.get(i).and_then(Value::as_f64).unwrap_or(0.0);
+            let string = |i: usize| {
+                row.get(i)
+                    .and_then(Value::as_str)
+                    .unwrap_or("?")
+                    .to_string()
+            };
+            let s = w.sites.entry((string(0), string(1))).or_default();
+            s.calls += cell(2);
+            s.chars += cell(3);
+            s.ms += cell(4);
+        }
+        if let Some(stacks) = r.get("stacks").and_then(Value::as_object) {
+            for (site, frames) in stacks {
+                let frames = frames.as_array().into_iter().flatten();
+                let frames = frames.filter_map(Value::as_str).map(str::to_string);
+                w.stacks.insert(site.clone(), frames.collect());
+            }
+        }
+    }
+    for r in report.of_kind("console_file") {
+        webviews.entry(webview_of(r)).or_default().file = Some(text(r, "path").to_string());
+    }
+    for r in report.of_kind("console_rotated") {
+        let w = webviews.entry(webview_of(r)).or_default();
+        w.rotations = w.rotations.max(num(r, "rotations"));
+    }
+    if webviews.is_empty() {
+        return;
+    }
+
+    heading("Console");
+    for (webview, w) in webviews {
+        println!(
+            "  webview {}: {} call(s), {:.1} K chars, {:.1} ms in console methods over {} active second(s)",
+            webview,
+            w.calls,
+            w.chars / 1024.0,
+            w.ms,
+            w.seconds
+        );
+        if let Some(file) = &w.file {
+            print!("    output in {}", file);
+            if w.rotations > 0.0 {
+                print!(
+                    " (rotated {} time(s), older output in {}.1)",
+                    w.rotations, file
+                );
+            }
+            println!();
+        }
+
+        let mut sites: Vec<_> = w.sites.iter().collect();
+        sites.sort_by(|a, b| b.1.calls.total_cmp(&a.1.calls));
+        if !sites.is_empty() {
+            println!(
+                "    {:>8} {:>10} {:>8}  level  site",
+                "calls", "K chars", "ms"
+            );
+        }
+        for ((site, level), s) in sites.iter().take(TOP_SITES) {
+            println!(
+                "    {:>8} {:>10.1} {:>8.1}  {:<5}  {}",
+                s.calls,
+                s.chars / 1024.0,
+                s.ms,
+                level,
+                site
+            );
+            let frames = w.stacks.get(site).map(Vec::as_slice).unwrap_or(&[]);
+            for frame in frames.iter().skip(1).take(STACK_FRAMES) {
+                println!("           {}", frame);
+            }
+        }
+
+        if w.storms > 0.0 {
+            println!(
+                "    {} logging storm in {} second(s), up to {} calls and {:.0} K chars a second",
+                "warning:".yellow().bold(),
+                w.storms,
+                w.worst.0,
+                w.worst.1 / 1024.0
+            );
+        }
+        if w.dropped > 0.0 {
+            println!(
+                "    {} {} line(s) counted but not written to the console file",
+                "note:".cyan().bold(),
+                w.dropped
+            );
+        }
+    }
+}
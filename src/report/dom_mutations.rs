@@ -0,0 +1,165 @@
+//! `dom_mutations` and `dom_storm` records — DOM churn over time
+//!
+//! The page probe reports once per second with mutation counts by type and
+//! the subtree roots that changed most; a storm is one task that touched
+//! thousands of nodes. Seconds are lined up with the page's own clock (`pt`)
+//! so they can be read next to long-task blocks from the same webview.
+
+use super::{heading, num, webview_of, Report};
+use colored::Colorize;
+use serde_json::Value;
+use std::collections::{BTreeMap, HashMap};
+
+/// How many of the busiest seconds to show per webview
+const TIMELINE_ROWS: usize = 20;
+
+/// How many storms and roots to list per webview
+const TOP_STORMS: usize = 10;
+const TOP_ROOTS: usize = 5;
+
+struct Second {
+    pt_ms: f64,
+    records: f64,
+    added: f64,
+    removed: f64,
+    attributes: f64,
+    text: f64,
+    storms: f64,
+    root: String,
+}
+
+#[derive(Default)]
+struct Webview {
+    seconds: Vec<Second>,
+    roots: HashMap<String, f64>,
+    storms: Vec<(f64, f64, String)>,
+    blocks: Vec<(f64, f64)>,
+}
+
+/// `[[label, count], ...]` as written by the probe
+fn roots_of(record: &Value) -> Vec<(String, f64)> {
+    record
+        .get("roots")
+        .and_then(Value::as_array)
+        .map(|roots| {
+            roots
+                .iter()
+                .filter_map(|pair| {
+                    let label = pair.get(0)?.as_str()?.to_string();
+                    Some((label, pair.get(1)?.as_f64()?))
+                })
+                .collect()
+        })
+        .unwrap_or_default()
+}
+
+pub fn print(report: &Report) {
+    let mut webviews: BTreeMap<i64, Webview> = BTreeMap::new();
+    for r in report.of_kind("dom_mutations") {
+        let w = webviews.entry(webview_of(r)).or_default();
+        let roots = roots_of(r);
+        for (label, count) in &roots {
+            *w.roots.entry(label.clone()).or_default() += count;
+        }
+        w.seconds.push(Second {
+            pt_ms: num(r, "pt"),
+            records: num(r, "records"),
+            added: num(r, "added"),
+            removed: num(r, "removed"),
+            attributes: num(r, "attributes"),
+            text: num(r, "text"),
+            storms: num(r, "storms"),
+            root: roots.first().map(|r| r.0.clone()).unwrap_or_default(),
+        });
+    }
+    if webviews.is_empty() {
+        return;
+    }
+
+    for r in report.of_kind("dom_storm") {
+        if let Some(w) = webviews.get_mut(&webview_of(r)) {
+            let roots: Vec<String> = roots_of(r)
+                .into_iter()
+                .map(|(label, n)| format!("{} ({})", label, n))
+                .collect();
+            w.storms
+                .push((num(r, "pt"), num(r, "nodes"), roots.join(", ")));
+        }
+    }
+    for r in report.of_kind("long_task") {
+        if let Some(w) = webviews.get_mut(&webview_of(r)) {
+            w.blocks.push((num(r, "start_ms"), num(r, "dur_ms")));
+        }
+    }
+
+    heading("DOM mutations");
+    for (webview, mut w) in webviews {
+        let total: f64 = w.seconds.iter().map(|s| s.records).sum();
+        let nodes: f64 = w.seconds.iter().map(|s| s.added + s.removed).sum();
+        println!(
+            "  webview {}: {} mutation record(s), {} node(s) added or removed over {} active second(s), {} storm(s)",
+            webview,
+            total,
+            nodes,
+            w.seconds.len(),
+            w.storms.len()
+        );
+
+        let mut roots: Vec<(String, f64)> = w.roots.into_iter().collect();
+        roots.sort_by(|a, b| b.1.total_cmp(&a.1));
+        for (label, count) in roots.iter().take(TOP_ROOTS) {
+            println!("    {:>10} node(s)  {}", count, label);
+        }
+
+        // Busiest seconds, shown in time order
+        w.seconds.sort_by(|a, b| {
+            (b.added + b.removed + b.records).total_cmp(&(a.added + a.removed + a.records))
+        });
+        w.seconds.truncate(TIMELINE_ROWS);
+        w.seconds.sort_by(|a, b| a.pt_ms.total_cmp(&b.pt_ms));
+
+        println!(
+            "    {:>8} {:>8} {:>8} {:>8} {:>7} {:>6} {:>10}  top root",
+            "page s", "records", "added", "removed", "attrs", "text", "blocked ms"
+        );
+        for s in &w.seconds {
+            let blocked: f64 = w
+                .blocks
+                .iter()
+                .filter(|(start, _)| *start >= s.pt_ms - 1000.0 && *start < s.pt_ms)
+                .map(|(_, duration)| duration)
+                .sum();
+            let row = format!(
+                "    {:>8.1} {:>8} {:>8} {:>8} {:>7} {:>6} {:>10}  {}",
+                s.pt_ms / 1000.0,
+                s.records,
+                s.added,
+                s.removed,
+                s.attributes,
+                s.text,
+                if blocked > 0.0 {
+                    format!("{:.0}", blocked)
+                } else {
+                    "-".to_string()
+                },
+                s.root
+            );
+            if s.storms > 0.0 {
+                println!("{}", row.yellow());
+            } else {
+                println!("{}", row);
+            }
+        }
+
+        w.storms.sort_by(|a, b| b.1.total_cmp(&a.1));
+        for (pt_ms, nodes, roots) in w.storms.iter().take(TOP_STORMS) {
+            println!(
+                "    {} {} nodes in one task at {:.1} s: {}",
+                "warning:".yellow().bold(),
+                nodes,
+                pt_ms / 1000.0,
+                roots
+            );
+        }
+    }
+}
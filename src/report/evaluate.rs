@@ -0,0 +1,84 @@
+//! `eval` records — backend-to-frontend `evaluate_javascript` traffic
+
+use super::{bytes, heading, num, webview_of, Report};
+use colored::Colorize;
+use std::collections::BTreeMap;
+
+/// Calls per second above which a webview is flagged as flooded
+const FLOOD_CALLS_PER_S: f64 = 100.0;
+
+#[derive(Default)]
+struct Totals {
+    seconds: usize,
+    calls: f64,
+    run_calls: f64,
+    bytes: f64,
+    max_bytes: f64,
+    peak_calls: f64,
+    peak_bytes: f64,
+    completed: f64,
+    latency_sum_us: f64,
+    latency_max_us: f64,
+    max_pending: f64,
+}
+
+pub fn print(report: &Report) {
+    let mut by_webview: BTreeMap<i64, Totals> = BTreeMap::new();
+    for record in report.of_kind("eval") {
+        let t = by_webview.entry(webview_of(record)).or_default();
+        let calls = num(record, "calls");
+        let completed = num(record, "completed");
+        t.seconds += 1;
+        t.calls += calls;
+        t.run_calls += num(record, "run_calls");
+        t.bytes += num(record, "bytes");
+        t.max_bytes = t.max_bytes.max(num(record, "max_bytes"));
+        t.peak_calls = t.peak_calls.max(calls);
+        t.peak_bytes = t.peak_bytes.max(num(record, "bytes"));
+        t.completed += completed;
+        t.latency_sum_us += num(record, "latency_avg_us") * completed;
+        t.latency_max_us = t.latency_max_us.max(num(record, "latency_max_us"));
+        t.max_pending = t.max_pending.max(num(record, "pending"));
+    }
+
+    if by_webview.is_empty() {
+        return;
+    }
+
+    heading("JavaScript evaluation (backend → page)");
+    for (webview, t) in by_webview {
+        let mean_latency_ms = if t.completed > 0.0 {
+            t.latency_sum_us / t.completed / 1000.0
+        } else {
+            0.0
+        };
+
+        println!("  webview {}", webview);
+        println!(
+            "    calls      {} total ({} legacy run_javascript), peak {}/s over {} active second(s)",
+            t.calls,
+            t.run_calls,
+            t.peak_calls,
+            t.seconds
+        );
+        println!(
+            "    script     {} total, peak {}/s, largest {}",
+            bytes(t.bytes),
+            bytes(t.peak_bytes),
+            bytes(t.max_bytes)
+        );
+        println!(
+            "    latency    mean {:.2} ms, max {:.2} ms, up to {} in flight",
+            mean_latency_ms,
+            t.latency_max_us / 1000.0,
+            t.max_pending
+        );
+        if t.peak_calls >= FLOOD_CALLS_PER_S {
+            println!(
+                "    {} evaluation flood — {} calls in one second",
+                "warning:".yellow().bold(),
+                t.peak_calls
+            );
+        }
+    }
+}
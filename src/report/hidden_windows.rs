@@ -0,0 +1,128 @@
+//! `window_state`, `window_activity` and `raf_activity` records — rendering
+//! while a window is hidden
+//!
+//! libspy records every toplevel's state changes and, for each span (a
+//! second at most) a window spent hidden (unmapped, minimized or fully
+//! obscured), the frames it still painted and its share of the process CPU
+//! (and, with RAPL, package energy) — shared evenly when several windows are
+//! hidden at once. The page side counts rAF callbacks; those are matched to
+//! the hidden spans of the window holding their webview.
+
+use super::{heading, num, ts_of, webview_of, Report};
+use colored::Colorize;
+use serde_json::Value;
+use std::collections::BTreeMap;
+
+#[derive(Default)]
+struct Window {
+    webviews: Vec<i64>,
+    /// Hidden spans as [start, end) in report microseconds
+    hidden: Vec<(u64, Option<u64>)>,
+    seconds: f64,
+    frames: f64,
+    cpu_us: f64,
+    energy_uj: Option<f64>,
+    raf_callbacks: f64,
+    raf_page_visible: f64,
+}
+
+impl Window {
+    fn hidden_at(&self, ts: u64) -> bool {
+        self.hidden
+            .iter()
+            .any(|&(start, end)| ts >= start && end.map_or(true, |end| ts < end))
+    }
+}
+
+fn flag(record: &Value, field: &str) -> bool {
+    record.get(field).and_then(Value::as_bool).unwrap_or(false)
+}
+
+pub fn print(report: &Report) {
+    let mut windows: BTreeMap<i64, Window> = BTreeMap::new();
+    for r in report.of_kind("window_state") {
+        let w = windows.entry(num(r, "window") as i64).or_default();
+        if let Some(ids) = r.get("webviews").and_then(Value::as_array) {
+            w.webviews = ids.iter().filter_map(Value::as_i64).collect();
+        }
+
+        let open = matches!(w.hidden.last(), Some((_, None)));
+        if flag(r, "hidden") && !open {
+            w.hidden.push((ts_of(r), None));
+        } else if !flag(r, "hidden") && open {
+            w.hidden.last_mut().unwrap().1 = Some(ts_of(r));
+        }
+    }
+    if windows.is_empty() {
+        return;
+    }
+
+    for r in report.of_kind("window_activity") {
+        if let Some(w) = windows.get_mut(&(num(r, "window") as i64)) {
+            w.seconds += num(r, "span_us") / 1e6;
+            w.frames += num(r, "frames");
+            w.cpu_us += num(r, "cpu_us");
+            if r.get("energy_uj").is_some() {
+                *w.energy_uj.get_or_insert(0.0) += num(r, "energy_uj");
+            }
+        }
+    }
+
+    for r in report.of_kind("raf_activity") {
+        let webview = webview_of(r);
+        let ts = ts_of(r);
+        for w in windows.values_mut() {
+            if w.webviews.contains(&webview) && w.hidden_at(ts) {
+                w.raf_callbacks += num(r, "callbacks");
+                if r.get("visibility").and_then(Value::as_str) == Some("visible") {
+                    w.raf_page_visible += num(r, "callbacks");
+                }
+            }
+        }
+    }
+
+    heading("Hidden windows");
+    for (id, w) in windows {
+        let webviews: Vec<String> = w.webviews.iter().map(|v| v.to_string()).collect();
+        println!(
+            "  window {} (webviews {}): hidden {} time(s), {:.0} s in total",
+            id,
+            if webviews.is_empty() {
+                "none".to_string()
+            } else {
+                webviews.join(", ")
+            },
+            w.hidden.len(),
+            w.seconds
+        );
+        if w.seconds == 0.0 {
+            continue;
+        }
+
+        println!(
+            "    while hidden  {:.1} frames/s painted, {:.1} rAF callbacks/s, CPU {:.1}% (share of process)",
+            w.frames / w.seconds,
+            w.raf_callbacks / w.seconds,
+            w.cpu_us / w.seconds / 1e4
+        );
+        if let Some(energy) = w.energy_uj {
+            println!(
+                "    package power {:.2} W average (its share of the whole machine, RAPL)",
+                energy / w.seconds / 1e6
+            );
+        }
+        if w.raf_page_visible > 0.0 {
+            println!(
+                "    {} the page still reported itself visible for {} rAF callback(s)",
+                "note:".cyan().bold(),
+                w.raf_page_visible
+            );
+        }
+        if w.frames > 0.0 || w.raf_callbacks > 0.0 {
+            println!(
+                "    {} keeps rendering while hidden; pause animations on visibilitychange or when minimized",
+                "warning:".yellow().bold()
+            );
+        }
+    }
+}
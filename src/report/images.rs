@@ -0,0 +1,180 @@
+//! `images` records — decoded image memory against rendered size
+//!
+//! The page probe rescans whenever the DOM settles and reports the largest
+//! bitmaps as `[url, kind, natural_w, natural_h, shown_w, shown_h, elements,
+//! decoded_bytes, file_bytes, decode_ms, sync]`, sizes in device pixels. Rows
+//! are merged by URL across scans, keeping the latest.
+
+use super::{bytes, heading, num, webview_of, Report};
+use colored::Colorize;
+use serde_json::Value;
+use std::collections::{BTreeMap, HashMap};
+
+/// Natural area this many times the shown area counts as oversized
+const OVERSIZE_FACTOR: f64 = 2.0;
+
+/// Decoded memory held beyond rendered size worth a warning
+const WASTE_LIMIT: f64 = 16.0 * 1024.0 * 1024.0;
+
+/// Main-thread decode long enough to drop a frame
+const DECODE_LIMIT_MS: f64 = 16.0;
+
+/// How many images to list per webview
+const TOP_IMAGES: usize = 15;
+
+struct Image {
+    kind: String,
+    natural: (f64, f64),
+    shown: (f64, f64),
+    elements: f64,
+    decoded: f64,
+    file: Option<f64>,
+    decode_ms: f64,
+    sync: bool,
+}
+
+impl Image {
+    fn from_row(row: &[Value]) -> Option<(String, Image)> {
+        let cell = |i: usize| row.get(i).and_then(Value::as_f64).unwrap_or(0.0);
+        let url = row.first()?.as_str()?.to_string();
+        Some((
+            url,
+            Image {
+                kind: row.get(1)?.as_str()?.to_string(),
+                natural: (cell(2), cell(3)),
+                shown: (cell(4), cell(5)),
+                elements: cell(6),
+                decoded: cell(7),
+                file: row.get(8).and_then(Value::as_f64),
+                decode_ms: cell(9),
+                sync: row.get(10).and_then(Value::as_bool).unwrap_or(false),
+            },
+        ))
+    }
+
+    fn shown_area(&self) -> f64 {
+        self.shown.0 * self.shown.1
+    }
+
+    fn wasted(&self) -> f64 {
+        let shown = self.shown_area() * 4.0;
+        if shown > 0.0 {
+            (self.decoded - shown).max(0.0)
+        } else {
+            0.0
+        }
+    }
+
+    fn oversized(&self) -> bool {
+        let area = self.shown_area();
+        area > 0.0 && self.natural.0 * self.natural.1 >= area * OVERSIZE_FACTOR
+    }
+}
+
+#[derive(Default)]
+struct Webview {
+    scans: usize,
+    elements: f64,
+    decoded: f64,
+    peak_decoded: f64,
+    wasted: f64,
+    images: HashMap<String, Image>,
+}
+
+pub fn print(report: &Report) {
+    let mut webviews: BTreeMap<i64, Webview> = BTreeMap::new();
+    for r in report.of_kind("images") {
+        let w = webviews.entry(webview_of(r)).or_default();
+        w.scans += 1;
+        w.elements = num(r, "elements");
+        w.decoded = num(r, "decoded_bytes");
+        w.peak_decoded = w.peak_decoded.max(w.decoded);
+        w.wasted = num(r, "wasted_bytes");
+
+        let rows = r.get("items").and_then(Value::as_array);
+        for row in rows.into_iter().flatten().filter_map(Value::as_array) {
+            if let Some((url, image)) = Image::from_row(row) {
+                w.images.insert(url, image);
+            }
+        }
+    }
+    if webviews.is_empty() {
+        return;
+    }
+
+    heading("Images");
+    for (webview, w) in webviews {
+        println!(
+            "  webview {}: {} decoded at the last of {} scan(s) (peak {}), {} beyond rendered size, {} elements",
+            webview,
+            bytes(w.decoded),
+            w.scans,
+            bytes(w.peak_decoded),
+            bytes(w.wasted),
+            w.elements
+        );
+
+        let mut images: Vec<(String, Image)> = w.images.into_iter().collect();
+        images.sort_by(|a, b| {
+            b.1.wasted()
+                .total_cmp(&a.1.wasted())
+                .then(b.1.decoded.total_cmp(&a.1.decoded))
+        });
+        println!(
+            "    {:>9} {:>9} {:>11} {:>11} {:>9}  url",
+            "decoded", "file", "natural", "shown", "decode ms"
+        );
+        for (url, image) in images.iter().take(TOP_IMAGES) {
+            let file = image.file.map(bytes).unwrap_or_else(|| "-".to_string());
+            let shown = if image.shown_area() > 0.0 {
+                format!("{}x{}", image.shown.0, image.shown.1)
+            } else {
+                "not shown".to_string()
+            };
+            let mut flags = Vec::new();
+            if image.kind == "background" {
+                flags.push("background");
+            }
+            if image.oversized() {
+                flags.push("oversized");
+            }
+            if image.elements > 1.0 {
+                flags.push("shared");
+            }
+            println!(
+                "    {:>9} {:>9} {:>11} {:>11} {:>9.1}  {}{}",
+                bytes(image.decoded),
+                file,
+                format!("{}x{}", image.natural.0, image.natural.1),
+                shown,
+                image.decode_ms,
+                url,
+                if flags.is_empty() {
+                    String::new()
+                } else {
+                    format!(" [{}]", flags.join(", "))
+                }
+            );
+        }
+
+        if w.wasted >= WASTE_LIMIT {
+            println!(
+                "    {} {} of decoded bitmaps is never displayed; ship assets at the size they are shown",
+                "warning:".yellow().bold(),
+                bytes(w.wasted)
+            );
+        }
+        let slow: Vec<&(String, Image)> = images
+            .iter()
+            .filter(|(_, image)| image.sync && image.decode_ms >= DECODE_LIMIT_MS)
+            .collect();
+        if !slow.is_empty() {
+            println!(
+                "    {} {} image(s) take ≥ {} ms to decode on the main thread; use decoding=\"async\" or smaller files",
+                "note:".cyan().bold(),
+                slow.len(),
+                DECODE_LIMIT_MS
+            );
+        }
+    }
+}
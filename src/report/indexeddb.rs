@@ -0,0 +1,224 @@
+//! `indexeddb`, `idb_open` and `idb_long_transaction` records — IndexedDB
+//! request latency and transaction lifetimes
+//!
+//! Each `indexeddb` record covers one second as `operations` rows `[db,
+//! store, op, count, ms, max_ms, errors, steps]` (latency from the call to
+//! the first success or error, `steps` being later cursor results) and
+//! `transactions` rows `[db, mode, count, ms, max_ms, aborted]`.
+
+use super::{heading, num, text, webview_of, Report};
+use colored::Colorize;
+use serde_json::Value;
+use std::collections::{BTreeMap, HashMap};
+
+/// Average request latency worth a note
+const SLOW_REQUEST_MS: f64 = 16.0;
+
+/// How many operations and long transactions to list per webview
+const TOP_OPERATIONS: usize = 15;
+const TOP_TRANSACTIONS: usize = 5;
+const STACK_FRAMES: usize = 4;
+
+#[derive(Default)]
+struct Operation {
+    count: f64,
+    ms: f64,
+    max_ms: f64,
+    errors: f64,
+    steps: f64,
+}
+
+#[derive(Default)]
+struct Transactions {
+    count: f64,
+    ms: f64,
+    max_ms: f64,
+    aborted: f64,
+}
+
+struct Long {
+    db: String,
+    stores: String,
+    mode: String,
+    ms: f64,
+    queued: f64,
+    aborted: bool,
+    site: String,
+    stack: Vec<String>,
+}
+
+#[derive(Default)]
+struct Webview {
+    operations: HashMap<(String, String, String), Operation>,
+    transactions: BTreeMap<(String, String), Transactions>,
+    opens: Vec<(String, f64, Option<f64>, bool, Option<String>)>,
+    long: Vec<Long>,
+}
+
+fn strings(record: &Value, field: &str) -> Vec<String> {
+    let items = record.get(field).and_then(Value::as_array);
+    items
+        .into_iter()
+        .flatten()
+        .filter_map(Value::as_str)
+        .map(str::to_string)
+        .collect()
+}
+
+pub fn print(report: &Report) {
+    let mut webviews: BTreeMap<i64, Webview> = BTreeMap::new();
+    for r in report.of_kind("indexeddb") {
+        let w = webviews.entry(webview_of(r)).or_default();
+        let rows = r.get("operations").and_then(Value::as_array);
+        for row in rows.into_iter().flatten().filter_map(Value::as_array) {
+            let cell = |i: usize| row.get(i).and_then(Value::as_f64).unwrap_or(0.0);
+            let string = |i: usize| {
+                row.get(i)
+                    .and_then(Value::as_str)
+                    .unwrap_or("?")
+                    .to_string()
+            };
+            let o = w
+                .operations
+                .entry((string(0), string(1), string(2)))
+                .or_default();
+            o.count += cell(3);
+            o.ms += cell(4);
+            o.max_ms = o.max_ms.max(cell(5));
+            o.errors += cell(6);
+            o.steps += cell(7);
+        }
+        let rows = r.get("transactions").and_then(Value::as_array);
+        for row in rows.into_iter().flatten().filter_map(Value::as_array) {
+            let cell = |i: usize| row.get(i).and_then(Value::as_f64).unwrap_or(0.0);
+            let string = |i: usize| {
+                row.get(i)
+                    .and_then(Value::as_str)
+                    .unwrap_or("?")
+                    .to_string()
+            };
+            let t = w.transactions.entry((string(0), string(1))).or_default();
+            t.count += cell(2);
+            t.ms += cell(3);
+            t.max_ms = t.max_ms.max(cell(4));
+            t.aborted += cell(5);
+        }
+    }
+    for r in report.of_kind("idb_open") {
+        let w = webviews.entry(webview_of(r)).or_default();
+        w.opens.push((
+            text(r, "db").to_string(),
+            num(r, "ms"),
+            r.get("upgrade_ms").and_then(Value::as_f64),
+            r.get("blocked").and_then(Value::as_bool).unwrap_or(false),
+            r.get("error").and_then(Value::as_str).map(str::to_string),
+        ));
+    }
+    for r in report.of_kind("idb_long_transaction") {
+        let w = webviews.entry(webview_of(r)).or_default();
+        w.long.push(Long {
+            db: text(r, "db").to_string(),
+            stores: strings(r, "stores").join(", "),
+            mode: text(r, "mode").to_string(),
+            ms: num(r, "ms"),
+            queued: num(r, "queued"),
+            aborted: r.get("aborted").and_then(Value::as_bool).unwrap_or(false),
+            site: text(r, "site").to_string(),
+            stack: strings(r, "stack"),
+        });
+    }
+    if webviews.is_empty() {
+        return;
+    }
+
+    heading("IndexedDB");
+    for (webview, mut w) in webviews {
+        let requests: f64 = w.operations.values().fold(0.0, |n, o| n + o.count);
+        let total_ms: f64 = w.operations.values().fold(0.0, |n, o| n + o.ms);
+        println!(
+            "  webview {}: {} request(s), {:.1} ms waiting on them, {} long read-write transaction(s)",
+            webview,
+            requests,
+            total_ms,
+            w.long.len()
+        );
+        for (db, ms, upgrade_ms, blocked, error) in &w.opens {
+            print!("    open {} took {:.1} ms", db, ms);
+            if let Some(upgrade_ms) = upgrade_ms {
+                print!(", {:.1} ms of it upgrading", upgrade_ms);
+            }
+            if *blocked {
+                print!(", blocked by another connection");
+            }
+            if let Some(error) = error {
+                print!(", failed: {}", error);
+            }
+            println!();
+        }
+
+        let mut operations: Vec<_> = w.operations.iter().collect();
+        operations.sort_by(|a, b| b.1.ms.total_cmp(&a.1.ms));
+        if !operations.is_empty() {
+            println!(
+                "    {:>7} {:>8} {:>8} {:>8} {:>6} {:>7}  db / store / op",
+                "reqs", "ms", "avg ms", "max ms", "errors", "steps"
+            );
+        }
+        for ((db, store, op), o) in operations.iter().take(TOP_OPERATIONS) {
+            println!(
+                "    {:>7} {:>8.1} {:>8.2} {:>8.2} {:>6} {:>7}  {} / {} / {}",
+                o.count,
+                o.ms,
+                o.ms / o.count.max(1.0),
+                o.max_ms,
+                o.errors,
+                o.steps,
+                db,
+                store,
+                op
+            );
+        }
+        for ((db, store, op), o) in &operations {
+            if o.count > 0.0 && o.ms / o.count >= SLOW_REQUEST_MS {
+                println!(
+                    "    {} {}() on {} / {} averages {:.1} ms a request",
+                    "note:".cyan().bold(),
+                    op,
+                    db,
+                    store,
+                    o.ms / o.count
+                );
+            }
+        }
+
+        for ((db, mode), t) in &w.transactions {
+            println!(
+                "    {} {} transaction(s) on {}: {:.1} ms average, {:.1} ms max, {} aborted",
+                t.count,
+                mode,
+                db,
+                t.ms / t.count.max(1.0),
+                t.max_ms,
+                t.aborted
+            );
+        }
+
+        w.long.sort_by(|a, b| b.ms.total_cmp(&a.ms));
+        for l in w.long.iter().take(TOP_TRANSACTIONS) {
+            println!(
+                "    {} {} transaction on {} ({}) stayed open {:.1} ms{}, {} transaction(s) queued behind it {}",
+                "warning:".yellow().bold(),
+                l.mode,
+                l.db,
+                l.stores,
+                l.ms,
+                if l.aborted { " and aborted" } else { "" },
+                l.queued,
+                l.site
+            );
+            for frame in l.stack.iter().skip(1).take(STACK_FRAMES) {
+                println!("         {}", frame);
+            }
+        }
+    }
+}
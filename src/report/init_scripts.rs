@@ -0,0 +1,87 @@
+//! `user_script` and `init_scripts` records — init-script cost per frame and
+//! per navigation
+
+use super::{bytes, heading, num, text, webview_of, Report};
+use serde_json::Value;
+use std::collections::BTreeMap;
+
+pub fn print(report: &Report) {
+    let registered: Vec<&Value> = report.of_kind("user_script").collect();
+    let navigations: Vec<&Value> = report.of_kind("init_scripts").collect();
+    if registered.is_empty() && navigations.is_empty() {
+        return;
+    }
+
+    heading("Init scripts");
+
+    if !registered.is_empty() {
+        // Each webview has its own content manager, and every navigation in
+        // it runs only that manager's scripts
+        let mut managers: BTreeMap<&str, [f64; 4]> = BTreeMap::new();
+        for r in &registered {
+            let m = managers.entry(text(r, "manager")).or_default();
+            m[0] += 1.0;
+            m[1] += num(r, "bytes");
+            if text(r, "frames") == "all" {
+                m[2] += num(r, "bytes");
+            }
+            if text(r, "injection") == "start" {
+                m[3] += num(r, "bytes");
+            }
+        }
+
+        println!(
+            "  {} script(s) registered on {} content manager(s)",
+            registered.len(),
+            managers.len()
+        );
+        println!(
+            "    {:<18} {:>7} {:>16} {:>16} {:>16}",
+            "manager", "scripts", "per navigation", "every subframe", "at doc start"
+        );
+        for (manager, [scripts, total, all_frames, at_start]) in &managers {
+            println!(
+                "    {:<18} {:>7} {:>16} {:>16} {:>16}",
+                manager,
+                scripts,
+                bytes(*total),
+                bytes(*all_frames),
+                bytes(*at_start)
+            );
+        }
+    }
+
+    if navigations.is_empty() {
+        return;
+    }
+
+    println!(
+        "  {:>7} {:>7} {:>10} {:>10} {:>11} {:>10}  url",
+        "webview", "scripts", "bytes", "eval ms", "at start ms", "ready at"
+    );
+    let mut slowest: Vec<(f64, f64, i64)> = Vec::new();
+    for nav in &navigations {
+        println!(
+            "  {:>7} {:>7} {:>10} {:>10.2} {:>11.2} {:>8.1}ms  {}",
+            webview_of(nav),
+            num(nav, "scripts"),
+            bytes(num(nav, "bytes")),
+            num(nav, "eval_ms"),
+            num(nav, "start_ms"),
+            num(nav, "start_done_ms"),
+            text(nav, "url")
+        );
+
+        // [id, bytes, ms] per script
+        for entry in nav.get("per_script").and_then(Value::as_array).into_iter().flatten() {
+            let field = |i: usize| entry.get(i).and_then(Value::as_f64).unwrap_or(0.0);
+            slowest.push((field(2), field(1), field(0) as i64));
+        }
+    }
+
+    slowest.sort_by(|a, b| b.0.total_cmp(&a.0));
+    println!("  slowest init scripts:");
+    for (ms, size, id) in slowest.iter().take(5) {
+        println!("    script #{:<4} {:>10} {:>8.2} ms", id, bytes(*size), ms);
+    }
+}
@@ -0,0 +1,141 @@
+//! `ipc_channel` and `eval_callback` records — Tauri Channel throughput and
+//! backpressure
+//!
+//! The page probe sees each channel message as it reaches the consumer; the
+//! native side sees the script that delivered it. Both use the Tauri callback
+//! id, so the two are joined per (webview, channel).
+//!
+//! The delivery latency is libspy's evaluate-script round trip: from the
+//! backend's evaluation call until WebKit hands its result back, which
+//! includes the wait for the page's main thread and the consumer's handler.
+//! It is not the time a message spent queued inside the channel.
+
+use super::{bytes, heading, num, webview_of, Report};
+use colored::Colorize;
+use std::collections::{BTreeMap, HashSet};
+
+/// Share of a second spent in the consumer's handler that means it can't
+/// keep up
+const BUSY_LIMIT: f64 = 0.8;
+
+/// Native delivery latency that means messages are backing up
+const DELIVERY_LIMIT_MS: f64 = 100.0;
+
+#[derive(Default)]
+struct Channel {
+    seconds: usize,
+    msgs: f64,
+    peak_msgs: f64,
+    bytes: f64,
+    peak_bytes: f64,
+    handler_ms: f64,
+    peak_busy: f64,
+    handler_max_ms: f64,
+    reordered: f64,
+    lag_max: f64,
+    ended: bool,
+    deliveries: f64,
+    fetches: f64,
+    /// Deliveries whose latency was measured, which latency_sum_us covers
+    completed: f64,
+    latency_sum_us: f64,
+    latency_max_us: f64,
+}
+
+pub fn print(report: &Report) {
+    let mut channels: BTreeMap<(i64, u64), Channel> = BTreeMap::new();
+    for r in report.of_kind("ipc_channel") {
+        let key = (webview_of(r), num(r, "channel") as u64);
+        let c = channels.entry(key).or_default();
+        c.seconds += 1;
+        c.msgs += num(r, "msgs");
+        c.peak_msgs = c.peak_msgs.max(num(r, "msgs"));
+        c.bytes += num(r, "bytes");
+        c.peak_bytes = c.peak_bytes.max(num(r, "bytes"));
+        c.handler_ms += num(r, "handler_ms");
+        c.peak_busy = c.peak_busy.max(num(r, "handler_ms") / 1000.0);
+        c.handler_max_ms = c.handler_max_ms.max(num(r, "handler_max_ms"));
+        c.reordered += num(r, "reordered");
+        c.lag_max = c.lag_max.max(num(r, "lag_max"));
+        c.ended |= r.get("ended").and_then(|v| v.as_bool()).unwrap_or(false);
+    }
+
+    // Native deliveries, only for callbacks the page identified as channels
+    let known: HashSet<(i64, u64)> = channels.keys().copied().collect();
+    for r in report.of_kind("eval_callback") {
+        let key = (webview_of(r), num(r, "callback") as u64);
+        if !known.contains(&key) {
+            continue;
+        }
+        let c = channels.get_mut(&key).unwrap();
+        c.deliveries += num(r, "calls");
+        c.fetches += num(r, "fetches");
+        c.completed += num(r, "completed");
+        c.latency_sum_us += num(r, "latency_avg_us") * num(r, "completed");
+        c.latency_max_us = c.latency_max_us.max(num(r, "latency_max_us"));
+    }
+
+    let unavailable = report.of_kind("ipc_channel_unavailable").count();
+    if channels.is_empty() && unavailable == 0 {
+        return;
+    }
+
+    heading("IPC channels");
+    println!(
+        "  {} only Tauri Channel payloads ({{index, message}} or {{index, end}}) are recognized",
+        "note:".cyan().bold()
+    );
+    if unavailable > 0 {
+        println!(
+            "  {} channel probe could not hook transformCallback in {} document(s)",
+            "note:".cyan().bold(),
+            unavailable
+        );
+    }
+
+    for ((webview, id), c) in channels {
+        let seconds = c.seconds.max(1) as f64;
+        println!(
+            "  webview {} channel {}{}",
+            webview,
+            id,
+            if c.ended { " (ended)" } else { "" }
+        );
+        println!(
+            "    throughput  {:.1} msg/s avg, {} msg/s peak; {}/s avg, {}/s peak",
+            c.msgs / seconds,
+            c.peak_msgs,
+            bytes(c.bytes / seconds),
+            bytes(c.peak_bytes)
+        );
+        println!(
+            "    consumer    {:.1}% busy avg, {:.1}% peak, slowest message {:.2} ms",
+            c.handler_ms / seconds / 10.0,
+            c.peak_busy * 100.0,
+            c.handler_max_ms
+        );
+        if c.completed > 0.0 {
+            let mean_ms = c.latency_sum_us / c.completed / 1000.0;
+            println!(
+                "    delivery    {:.2} ms mean, {:.2} ms max from eval call to completion ({} of {} via fetch)",
+                mean_ms,
+                c.latency_max_us / 1000.0,
+                c.fetches,
+                c.deliveries
+            );
+        }
+        if c.reordered > 0.0 {
+            println!(
+                "    ordering    {} message(s) arrived early, up to {} buffered",
+                c.reordered, c.lag_max
+            );
+        }
+
+        if c.peak_busy >= BUSY_LIMIT || c.latency_max_us / 1000.0 >= DELIVERY_LIMIT_MS {
+            println!(
+                "    {} consumer is not keeping up with this channel",
+                "warning:".yellow().bold()
+            );
+        }
+    }
+}
@@ -0,0 +1,97 @@
+//! `layout_thrash` records — forced synchronous layouts by call site
+//!
+//! Each record covers one second of layout reads that followed a DOM or
+//! style write in the same task, for one (call site, property) pair. The
+//! first record for a pair carries the JS stack that led to it.
+
+use super::{heading, num, text, webview_of, Report};
+use colored::Colorize;
+use serde_json::Value;
+use std::collections::BTreeMap;
+
+/// Forced layout time in one second, at one site, that is worth fixing
+const THRASH_MS: f64 = 50.0;
+
+/// How many sites to list per webview, and how many of those get stacks
+const TOP_SITES: usize = 10;
+const TOP_STACKS: usize = 3;
+
+#[derive(Default)]
+struct Site {
+    write: String,
+    count: f64,
+    ms: f64,
+    max_ms: f64,
+    peak_second_ms: f64,
+    stack: Vec<String>,
+}
+
+pub fn print(report: &Report) {
+    let mut webviews: BTreeMap<i64, BTreeMap<(String, String), Site>> = BTreeMap::new();
+    for r in report.of_kind("layout_thrash") {
+        let key = (text(r, "site").to_string(), text(r, "read").to_string());
+        let s = webviews
+            .entry(webview_of(r))
+            .or_default()
+            .entry(key)
+            .or_default();
+        s.count += num(r, "count");
+        s.ms += num(r, "ms");
+        s.max_ms = s.max_ms.max(num(r, "max_ms"));
+        s.peak_second_ms = s.peak_second_ms.max(num(r, "ms"));
+        if s.write.is_empty() {
+            s.write = text(r, "write").to_string();
+        }
+        if let Some(frames) = r.get("stack").and_then(Value::as_array) {
+            s.stack = frames
+                .iter()
+                .filter_map(Value::as_str)
+                .map(str::to_string)
+                .collect();
+        }
+    }
+
+    if webviews.is_empty() {
+        return;
+    }
+
+    heading("Forced layouts");
+    for (webview, sites) in webviews {
+        let total_ms: f64 = sites.values().map(|s| s.ms).sum();
+        let total: f64 = sites.values().map(|s| s.count).sum();
+        println!(
+            "  webview {}: {} forced layout(s), {:.1} ms, at {} site(s)",
+            webview,
+            total,
+            total_ms,
+            sites.len()
+        );
+
+        let mut sites: Vec<((String, String), Site)> = sites.into_iter().collect();
+        sites.sort_by(|a, b| b.1.ms.total_cmp(&a.1.ms));
+        println!(
+            "    {:>9} {:>7} {:>9}  read after write",
+            "total ms", "count", "max ms"
+        );
+        for (i, ((site, read), s)) in sites.iter().take(TOP_SITES).enumerate() {
+            let write = if s.write.is_empty() { "?" } else { &s.write };
+            println!(
+                "    {:>9.1} {:>7} {:>9.2}  {} after {}",
+                s.ms, s.count, s.max_ms, read, write
+            );
+            println!("      at {}", site);
+            if i < TOP_STACKS {
+                for frame in s.stack.iter().skip(1) {
+                    println!("         {}", frame);
+                }
+            }
+            if s.peak_second_ms >= THRASH_MS {
+                println!(
+                    "      {} {:.0} ms of forced layout in one second; batch reads before writes",
+                    "warning:".yellow().bold(),
+                    s.peak_second_ms
+                );
+            }
+        }
+    }
+}
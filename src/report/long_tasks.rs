@@ -0,0 +1,115 @@
+//! `long_task` records — main-thread blocks seen from inside the page
+//!
+//! Each record is one block of at least 50 ms, found either by the heartbeat
+//! (any task) or by a gap between animation frames, and attributed to a
+//! script where the probe could guess one.
+
+use super::{heading, num, text, webview_of, Report};
+use colored::Colorize;
+use std::collections::{BTreeMap, HashMap};
+
+/// Blocks at least this long are visible as a frozen UI
+const FREEZE_MS: f64 = 250.0;
+
+/// Upper bounds of the duration histogram, in ms
+const BUCKETS: &[f64] = &[100.0, 250.0, 1000.0, f64::INFINITY];
+
+/// How many scripts to list per webview
+const TOP_SCRIPTS: usize = 5;
+
+#[derive(Default)]
+struct Webview {
+    count: usize,
+    total_ms: f64,
+    longest_ms: f64,
+    longest_at_ms: f64,
+    hidden: usize,
+    by_frame: usize,
+    buckets: [usize; 4],
+    scripts: HashMap<String, (usize, f64)>,
+    unattributed_ms: f64,
+}
+
+fn bucket_label(i: usize) -> String {
+    let low = if i == 0 { 50.0 } else { BUCKETS[i - 1] };
+    if BUCKETS[i].is_infinite() {
+        format!(">{} ms", low)
+    } else {
+        format!("{}-{} ms", low, BUCKETS[i])
+    }
+}
+
+pub fn print(report: &Report) {
+    let mut webviews: BTreeMap<i64, Webview> = BTreeMap::new();
+    for r in report.of_kind("long_task") {
+        let w = webviews.entry(webview_of(r)).or_default();
+        let duration = num(r, "dur_ms");
+
+        w.count += 1;
+        w.total_ms += duration;
+        if duration > w.longest_ms {
+            w.longest_ms = duration;
+            w.longest_at_ms = num(r, "start_ms");
+        }
+        if !r.get("visible").and_then(|v| v.as_bool()).unwrap_or(true) {
+            w.hidden += 1;
+        }
+        if text(r, "detector") == "frame" {
+            w.by_frame += 1;
+        }
+        let bucket = BUCKETS.iter().position(|&b| duration < b).unwrap_or(3);
+        w.buckets[bucket] += 1;
+
+        match text(r, "script") {
+            "" => w.unattributed_ms += duration,
+            script => {
+                let s = w.scripts.entry(script.to_string()).or_default();
+                s.0 += 1;
+                s.1 += duration;
+            }
+        }
+    }
+
+    if webviews.is_empty() {
+        return;
+    }
+
+    heading("Long tasks");
+    for (webview, w) in webviews {
+        println!(
+            "  webview {}: {} block(s), {:.0} ms blocked, longest {:.0} ms at {:.0} ms",
+            webview, w.count, w.total_ms, w.longest_ms, w.longest_at_ms
+        );
+        let histogram: Vec<String> = w
+            .buckets
+            .iter()
+            .enumerate()
+            .filter(|(_, &n)| n > 0)
+            .map(|(i, n)| format!("{} {}", n, bucket_label(i)))
+            .collect();
+        println!("    durations   {}", histogram.join(", "));
+        println!(
+            "    detected    {} by heartbeat, {} by frame gap; {} while hidden",
+            w.count - w.by_frame,
+            w.by_frame,
+            w.hidden
+        );
+
+        let mut scripts: Vec<(String, (usize, f64))> = w.scripts.into_iter().collect();
+        scripts.sort_by(|a, b| b.1 .1.total_cmp(&a.1 .1));
+        for (script, (count, ms)) in scripts.iter().take(TOP_SCRIPTS) {
+            println!("    {:>8.0} ms {:>5}x  {}", ms, count, script);
+        }
+        if w.unattributed_ms > 0.0 {
+            println!("    {:>8.0} ms        (no script identified)", w.unattributed_ms);
+        }
+
+        if w.longest_ms >= FREEZE_MS {
+            println!(
+                "    {} main thread froze for {:.0} ms; split the work or move it off the main thread",
+                "warning:".yellow().bold(),
+                w.longest_ms
+            );
+        }
+    }
+}
@@ -0,0 +1,234 @@
+//! `tauri-spy report` — summarize a libspy telemetry report
+//!
+//! libspy's recorder writes one JSON object per line. Every record carries
+//! `ts` (microseconds since the recorder opened), `webview` (libspy's id for
+//! the webview, -1 for process-wide records) and `kind`; records coming from
+//! page probes also carry `pt`, the page's `performance.now()` in ms. Each
+//! kind of record is summarized by its own section.
+
+mod animations;
+mod canvas;
+mod components;
+mod console;
+mod dom_mutations;
+mod evaluate;
+mod hidden_windows;
+mod images;
+mod indexeddb;
+mod init_scripts;
+mod ipc_channels;
+mod layout_thrash;
+mod long_tasks;
+mod raf;
+mod scroll_listeners;
+mod storage;
+mod timers;
+mod wakeups;
+mod wasm;
+mod workers;
+
+use crate::sourcemap::Resolver;
+use colored::Colorize;
+use serde_json::Value;
+use std::collections::BTreeMap;
+use std::fs;
+use std::path::Path;
+
+/// A loaded report: every well-formed record, in file order
+pub struct Report {
+    pub records: Vec<Value>,
+    pub skipped: usize,
+}
+
+impl Report {
+    pub fn load(path: &Path) -> Result<Report, String> {
+        let text = fs::read_to_string(path)
+            .map_err(|e| format!("Failed to read report {}: {}", path.display(), e))?;
+
+        let mut records = Vec::new();
+        let mut skipped = 0;
+        for line in text.lines().filter(|l| !l.trim().is_empty()) {
+            match serde_json::from_str::<Value>(line) {
+                Ok(record) if record.get("kind").and_then(Value::as_str).is_some() => {
+                    records.push(record)
+                }
+                // A truncated last line is expected if the target was killed
+                _ => skipped += 1,
+            }
+        }
+
+        Ok(Report { records, skipped })
+    }
+
+    /// All records of one kind, in file order
+    pub fn of_kind<'a>(&'a self, kind: &'a str) -> impl Iterator<Item = &'a Value> + 'a {
+        self.records.iter().filter(move |r| kind_of(r) == kind)
+    }
+}
+
+pub fn kind_of(record: &Value) -> &str {
+    record.get("kind").and_then(Value::as_str).unwrap_or("")
+}
+
+pub fn webview_of(record: &Value) -> i64 {
+    record.get("webview").and_then(Value::as_i64).unwrap_or(-1)
+}
+
+pub fn ts_of(record: &Value) -> u64 {
+    record.get("ts").and_then(Value::as_u64).unwrap_or(0)
+}
+
+pub fn num(record: &Value, field: &str) -> f64 {
+    record.get(field).and_then(Value::as_f64).unwrap_or(0.0)
+}
+
+pub fn text<'a>(record: &'a Value, field: &str) -> &'a str {
+    record.get(field).and_then(Value::as_str).unwrap_or("")
+}
+
+/// Section heading, matching the CLI's launch output
+pub fn heading(title: &str) {
+    println!();
+    println!("{} {}", "==".cyan().bold(), title.bold());
+}
+
+/// Format a byte count for humans
+pub fn bytes(n: f64) -> String {
+    if n >= 1024.0 * 1024.0 {
+        format!("{:.1} MB", n / (1024.0 * 1024.0))
+    } else if n >= 1024.0 {
+        format!("{:.1} KB", n / 1024.0)
+    } else {
+        format!("{} B", n as u64)
+    }
+}
+
+fn overview(report: &Report) {
+    heading("Overview");
+
+    let span_s = report
+        .records
+        .iter()
+        .map(ts_of)
+        .max()
+        .unwrap_or(0) as f64
+        / 1e6;
+    println!("  {} records over {:.1} s", report.records.len(), span_s);
+    if report.skipped > 0 {
+        println!(
+            "  {} {} malformed line(s) skipped",
+            "note:".cyan().bold(),
+            report.skipped
+        );
+    }
+
+    let mut counts: BTreeMap<(&str, i64), usize> = BTreeMap::new();
+    for record in &report.records {
+        *counts.entry((kind_of(record), webview_of(record))).or_default() += 1;
+    }
+
+    println!("  {:<20} {:>8} {:>10}", "kind", "webview", "records");
+    for ((kind, webview), count) in counts {
+        let webview = if webview < 0 {
+            "-".to_string()
+        } else {
+            webview.to_string()
+        };
+        println!("  {:<20} {:>8} {:>10}", kind, webview, count);
+    }
+}
+
+/// Map recorded JS frames back to original sources, through the maps in
+/// `dir` and those the `source-maps` probe recorded as `srcmap` records
+fn resolve_frames(report: &mut Report, dir: Option<&Path>) {
+    let mut resolver = Resolver::new(dir);
+    let mut too_large = Vec::new();
+    for record in &mut report.records {
+        if kind_of(record) == "srcmap" {
+            let url = text(record, "url").to_string();
+            match record.get_mut("map").map(Value::take) {
+                Some(Value::String(map)) => resolver.add_recorded(&url, &map),
+                _ => too_large.push(url),
+            }
+        }
+    }
+    for url in &too_large {
+        println!(
+            "  {} source map of {} was too large to record; pass it with --source-maps",
+            "note:".cyan().bold(),
+            url
+        );
+    }
+    if resolver.is_empty() {
+        return;
+    }
+
+    let mut frames = 0;
+    for record in &mut report.records {
+        if kind_of(record) != "srcmap" {
+            frames += resolver.rewrite(record);
+        }
+    }
+    println!(
+        "  {} resolved {} frame(s) through {} source map(s)",
+        "note:".cyan().bold(),
+        frames,
+        resolver.maps_loaded()
+    );
+    for error in &resolver.errors {
+        println!(
+            "  {} skipped source map {}",
+            "warning:".yellow().bold(),
+            error
+        );
+    }
+}
+
+pub fn run(
+    path: &Path,
+    flamegraph: Option<&Path>,
+    source_maps: Option<&Path>,
+) -> Result<(), String> {
+    let mut report = Report::load(path)?;
+
+    println!(
+        "{} Report {}",
+        "tauri-spy".cyan().bold(),
+        path.display().to_string().green()
+    );
+    overview(&report);
+    resolve_frames(&mut report, source_maps);
+    evaluate::print(&report);
+    init_scripts::print(&report);
+    wasm::print(&report);
+    storage::print(&report);
+    indexeddb::print(&report);
+    ipc_channels::print(&report);
+    long_tasks::print(&report);
+    layout_thrash::print(&report);
+    dom_mutations::print(&report);
+    components::print(&report);
+    timers::print(&report);
+    raf::print(&report);
+    images::print(&report);
+    animations::print(&report);
+    canvas::print(&report);
+    scroll_listeners::print(&report);
+    console::print(&report);
+    workers::print(&report);
+    wakeups::print(&report);
+    hidden_windows::print(&report);
+
+    if let Some(out) = flamegraph {
+        let stacks = components::write_flamegraph(&report, out)?;
+        println!();
+        println!(
+            "{} Wrote {} component stack(s) to {}",
+            "note:".cyan().bold(),
+            stacks,
+            out.display()
+        );
+    }
+
+    Ok(())
+}
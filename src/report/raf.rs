@@ -0,0 +1,158 @@
+//! `raf_frames` and `raf_overrun` records — requestAnimationFrame work
+//!
+//! Each `raf_frames` record covers one second of frames that ran rAF
+//! callbacks, with a `[site, calls, ms, max_ms]` row per registering call
+//! site. A `raf_overrun` is one frame whose callbacks alone took longer than
+//! a 60 Hz frame.
+
+use super::{heading, num, webview_of, Report};
+use colored::Colorize;
+use serde_json::Value;
+use std::collections::{BTreeMap, HashMap};
+
+/// Share of frames over budget that shows up as visible jank
+const OVERRUN_SHARE_LIMIT: f64 = 0.05;
+
+/// How many sites and overruns to list per webview
+const TOP_SITES: usize = 10;
+const TOP_STACKS: usize = 3;
+const TOP_OVERRUNS: usize = 5;
+
+#[derive(Default)]
+struct Site {
+    calls: f64,
+    ms: f64,
+    max_ms: f64,
+}
+
+#[derive(Default)]
+struct Webview {
+    seconds: f64,
+    frames: f64,
+    callbacks: f64,
+    max_per_frame: f64,
+    ms: f64,
+    max_frame_ms: f64,
+    over_budget: f64,
+    sites: HashMap<String, Site>,
+    stacks: HashMap<String, Vec<String>>,
+    overruns: Vec<(f64, f64, f64, String)>,
+}
+
+fn cell(row: &[Value], i: usize) -> f64 {
+    row.get(i).and_then(Value::as_f64).unwrap_or(0.0)
+}
+
+pub fn print(report: &Report) {
+    let mut webviews: BTreeMap<i64, Webview> = BTreeMap::new();
+    for r in report.of_kind("raf_frames") {
+        let w = webviews.entry(webview_of(r)).or_default();
+        w.seconds += 1.0;
+        w.frames += num(r, "frames");
+        w.callbacks += num(r, "callbacks");
+        w.max_per_frame = w.max_per_frame.max(num(r, "max_per_frame"));
+        w.ms += num(r, "ms");
+        w.max_frame_ms = w.max_frame_ms.max(num(r, "max_frame_ms"));
+        w.over_budget += num(r, "over_budget");
+
+        let rows = r.get("sites").and_then(Value::as_array);
+        for row in rows.into_iter().flatten().filter_map(Value::as_array) {
+            let name = row.first().and_then(Value::as_str).unwrap_or("");
+            let s = w.sites.entry(name.to_string()).or_default();
+            s.calls += cell(row, 1);
+            s.ms += cell(row, 2);
+            s.max_ms = s.max_ms.max(cell(row, 3));
+        }
+        if let Some(stacks) = r.get("stacks").and_then(Value::as_object) {
+            for (site, frames) in stacks {
+                let frames = frames.as_array().into_iter().flatten();
+                let frames = frames.filter_map(Value::as_str).map(str::to_string);
+                w.stacks.insert(site.clone(), frames.collect());
+            }
+        }
+    }
+    if webviews.is_empty() {
+        return;
+    }
+
+    for r in report.of_kind("raf_overrun") {
+        if let Some(w) = webviews.get_mut(&webview_of(r)) {
+            let sites: Vec<String> = r
+                .get("sites")
+                .and_then(Value::as_array)
+                .into_iter()
+                .flatten()
+                .filter_map(Value::as_array)
+                .map(|row| {
+                    let name = row.first().and_then(Value::as_str).unwrap_or("?");
+                    format!("{} ({:.1} ms)", name, cell(row, 1))
+                })
+                .collect();
+            w.overruns.push((
+                num(r, "pt"),
+                num(r, "frame_ms"),
+                num(r, "callbacks"),
+                sites.join(", "),
+            ));
+        }
+    }
+
+    heading("requestAnimationFrame");
+    for (webview, w) in webviews {
+        let frames = w.frames.max(1.0);
+        println!(
+            "  webview {}: {} frame(s) ran rAF work over {} s; {:.1} callbacks/frame (max {}), {:.2} ms/frame (max {:.1} ms)",
+            webview,
+            w.frames,
+            w.seconds,
+            w.callbacks / frames,
+            w.max_per_frame,
+            w.ms / frames,
+            w.max_frame_ms
+        );
+
+        let mut sites: Vec<(String, Site)> = w.sites.into_iter().collect();
+        sites.sort_by(|a, b| b.1.ms.total_cmp(&a.1.ms));
+        println!(
+            "    {:>8} {:>9} {:>9} {:>9}  site",
+            "calls/s", "total ms", "avg ms", "max ms"
+        );
+        for (i, (site, s)) in sites.iter().take(TOP_SITES).enumerate() {
+            println!(
+                "    {:>8.1} {:>9.1} {:>9.3} {:>9.2}  {}",
+                s.calls / w.seconds,
+                s.ms,
+                s.ms / s.calls.max(1.0),
+                s.max_ms,
+                site
+            );
+            if i < TOP_STACKS {
+                let frames = w.stacks.get(site).map(Vec::as_slice).unwrap_or(&[]);
+                for frame in frames.iter().skip(1) {
+                    println!("         {}", frame);
+                }
+            }
+        }
+
+        let mut overruns = w.overruns;
+        overruns.sort_by(|a, b| b.1.total_cmp(&a.1));
+        for (pt_ms, frame_ms, callbacks, sites) in overruns.iter().take(TOP_OVERRUNS) {
+            println!(
+                "    over budget at {:.1} s: {:.1} ms in {} callback(s): {}",
+                pt_ms / 1000.0,
+                frame_ms,
+                callbacks,
+                sites
+            );
+        }
+
+        if w.over_budget / frames >= OVERRUN_SHARE_LIMIT {
+            println!(
+                "    {} rAF work alone overran the frame budget in {} of {} frame(s)",
+                "warning:".yellow().bold(),
+                w.over_budget,
+                w.frames
+            );
+        }
+    }
+}
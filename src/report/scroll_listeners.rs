@@ -0,0 +1,173 @@
+//! `scroll_listener` and `scroll_handlers` records — listeners that hold up
+//! scrolling
+//!
+//! A `scroll_listener` is one wheel, touch or scroll listener registration
+//! (once per site, target and type) with its effective passivity. Each
+//! `scroll_handlers` record covers one second of handler runs as
+//! `[site, type, passive, calls, ms, max_ms, prevented]` rows.
+
+use super::{heading, text, webview_of, Report};
+use colored::Colorize;
+use serde_json::Value;
+use std::collections::{BTreeMap, HashMap};
+
+/// How many handlers to list per webview
+const TOP_HANDLERS: usize = 10;
+
+/// How many stack frames to print under a blocking listener
+const STACK_FRAMES: usize = 4;
+
+struct Listener {
+    kind: String,
+    target: String,
+    site: String,
+    explicit: bool,
+    stack: Vec<String>,
+}
+
+#[derive(Default)]
+struct Handler {
+    passive: bool,
+    calls: f64,
+    ms: f64,
+    max_ms: f64,
+    prevented: f64,
+}
+
+#[derive(Default)]
+struct Webview {
+    passive: usize,
+    blocking: Vec<Listener>,
+    handlers: HashMap<(String, String), Handler>,
+}
+
+fn is_blocking_type(kind: &str) -> bool {
+    kind != "scroll"
+}
+
+fn flag(record: &Value, field: &str) -> bool {
+    record.get(field).and_then(Value::as_bool).unwrap_or(false)
+}
+
+pub fn print(report: &Report) {
+    let mut webviews: BTreeMap<i64, Webview> = BTreeMap::new();
+    for r in report.of_kind("scroll_listener") {
+        let w = webviews.entry(webview_of(r)).or_default();
+        if flag(r, "passive") || !is_blocking_type(text(r, "type")) {
+            w.passive += 1;
+            continue;
+        }
+        let stack = r.get("stack").and_then(Value::as_array);
+        w.blocking.push(Listener {
+            kind: text(r, "type").to_string(),
+            target: text(r, "target").to_string(),
+            site: text(r, "site").to_string(),
+            explicit: flag(r, "explicit"),
+            stack: stack
+                .into_iter()
+                .flatten()
+                .filter_map(Value::as_str)
+                .map(str::to_string)
+                .collect(),
+        });
+    }
+    for r in report.of_kind("scroll_handlers") {
+        let w = webviews.entry(webview_of(r)).or_default();
+        let rows = r.get("sites").and_then(Value::as_array);
+        for row in rows.into_iter().flatten().filter_map(Value::as_array) {
+            let cell = |i: usize| row.get(i).and_then(Value::as_f64).unwrap_or(0.0);
+            let site = row.first().and_then(Value::as_str).unwrap_or("");
+            let kind = row.get(1).and_then(Value::as_str).unwrap_or("");
+            let h = w
+                .handlers
+                .entry((site.to_string(), kind.to_string()))
+                .or_default();
+            h.passive = row.get(2).and_then(Value::as_bool).unwrap_or(true);
+            h.calls += cell(3);
+            h.ms += cell(4);
+            h.max_ms = h.max_ms.max(cell(5));
+            h.prevented += cell(6);
+        }
+    }
+    if webviews.is_empty() {
+        return;
+    }
+
+    heading("Scroll-blocking listeners");
+    for (webview, w) in webviews {
+        println!(
+            "  webview {}: {} non-passive wheel/touch listener(s), {} passive or scroll",
+            webview,
+            w.blocking.len(),
+            w.passive
+        );
+        for l in &w.blocking {
+            println!(
+                "    {} {} on {} ({})",
+                if l.explicit {
+                    "passive: false"
+                } else {
+                    "default"
+                },
+                l.kind,
+                l.target,
+                l.site
+            );
+            for frame in l.stack.iter().skip(1).take(STACK_FRAMES) {
+                println!("         {}", frame);
+            }
+        }
+
+        if !w.handlers.is_empty() {
+            let mut handlers: Vec<_> = w.handlers.iter().collect();
+            handlers.sort_by(|a, b| b.1.ms.total_cmp(&a.1.ms));
+            println!(
+                "    {:>8} {:>9} {:>8} {:>8} {:>9}  handler",
+                "calls", "total ms", "avg ms", "max ms", "prevented"
+            );
+            for ((site, kind), h) in handlers.iter().take(TOP_HANDLERS) {
+                println!(
+                    "    {:>8} {:>9.1} {:>8.3} {:>8.2} {:>9}  {} {}{}",
+                    h.calls,
+                    h.ms,
+                    h.ms / h.calls.max(1.0),
+                    h.max_ms,
+                    if h.passive {
+                        "-".to_string()
+                    } else {
+                        h.prevented.to_string()
+                    },
+                    kind,
+                    site,
+                    if h.passive { "" } else { " [blocking]" }
+                );
+            }
+
+            let never: Vec<_> = handlers
+                .iter()
+                .filter(|((_, kind), h)| !h.passive && is_blocking_type(kind) && h.prevented == 0.0)
+                .collect();
+            if !never.is_empty() {
+                println!(
+                    "    {} {} blocking handler(s) never called preventDefault(); register them with {{ passive: true }}",
+                    "note:".cyan().bold(),
+                    never.len()
+                );
+            }
+        }
+
+        if !w.blocking.is_empty() {
+            let blocked_ms: f64 = w
+                .handlers
+                .values()
+                .filter(|h| !h.passive)
+                .map(|h| h.ms)
+                .sum();
+            println!(
+                "    {} wheel and touch scrolling waits for the main thread ({:.1} ms in blocking handlers); WebKit can't scroll asynchronously here",
+                "warning:".yellow().bold(),
+                blocked_ms
+            );
+        }
+    }
+}
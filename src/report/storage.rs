@@ -0,0 +1,156 @@
+//! `storage`, `storage_first_access` and `storage_large_read` records —
+//! synchronous localStorage, sessionStorage and cookie access
+//!
+//! Each `storage` record covers one second as `[area, key, reads,
+//! read_bytes, writes, write_bytes, ms, max_ms, starting]` rows, `starting`
+//! meaning before the page's load event. Bytes are UTF-16, as WebKit stores
+//! them.
+
+use super::{bytes, heading, num, text, webview_of, Report};
+use colored::Colorize;
+use serde_json::Value;
+use std::collections::{BTreeMap, HashMap};
+
+/// Storage time during startup worth a warning
+const STARTUP_LIMIT_MS: f64 = 50.0;
+
+/// How many keys to list per webview
+const TOP_KEYS: usize = 15;
+const STACK_FRAMES: usize = 4;
+
+#[derive(Default)]
+struct Key {
+    reads: f64,
+    read_bytes: f64,
+    writes: f64,
+    write_bytes: f64,
+    ms: f64,
+    max_ms: f64,
+    startup_ms: f64,
+}
+
+#[derive(Default)]
+struct Webview {
+    keys: HashMap<(String, String), Key>,
+    first: Vec<(String, String, f64, bool)>,
+    large: Vec<(String, String, f64, f64, String, Vec<String>)>,
+}
+
+pub fn print(report: &Report) {
+    let mut webviews: BTreeMap<i64, Webview> = BTreeMap::new();
+    for r in report.of_kind("storage") {
+        let w = webviews.entry(webview_of(r)).or_default();
+        let rows = r.get("items").and_then(Value::as_array);
+        for row in rows.into_iter().flatten().filter_map(Value::as_array) {
+            let cell = |i: usize| row.get(i).and_then(Value::as_f64).unwrap_or(0.0);
+            let string = |i: usize| row.get(i).and_then(Value::as_str).unwrap_or("?");
+            let k = w
+                .keys
+                .entry((string(0).to_string(), string(1).to_string()))
+                .or_default();
+            k.reads += cell(2);
+            k.read_bytes += cell(3);
+            k.writes += cell(4);
+            k.write_bytes += cell(5);
+            k.ms += cell(6);
+            k.max_ms = k.max_ms.max(cell(7));
+            if row.get(8).and_then(Value::as_bool).unwrap_or(false) {
+                k.startup_ms += cell(6);
+            }
+        }
+    }
+    for r in report.of_kind("storage_first_access") {
+        let w = webviews.entry(webview_of(r)).or_default();
+        w.first.push((
+            text(r, "area").to_string(),
+            text(r, "key").to_string(),
+            num(r, "ms"),
+            r.get("starting").and_then(Value::as_bool).unwrap_or(false),
+        ));
+    }
+    for r in report.of_kind("storage_large_read") {
+        let w = webviews.entry(webview_of(r)).or_default();
+        let stack = r.get("stack").and_then(Value::as_array);
+        w.large.push((
+            text(r, "area").to_string(),
+            text(r, "key").to_string(),
+            num(r, "bytes"),
+            num(r, "ms"),
+            text(r, "site").to_string(),
+            stack
+                .into_iter()
+                .flatten()
+                .filter_map(Value::as_str)
+                .map(str::to_string)
+                .collect(),
+        ));
+    }
+    if webviews.is_empty() {
+        return;
+    }
+
+    heading("Synchronous storage");
+    for (webview, w) in webviews {
+        let total_ms: f64 = w.keys.values().map(|k| k.ms).sum();
+        let startup_ms: f64 = w.keys.values().map(|k| k.startup_ms).sum();
+        println!(
+            "  webview {}: {} key(s), {:.1} ms in storage calls, {:.1} ms of it before load",
+            webview,
+            w.keys.len(),
+            total_ms,
+            startup_ms
+        );
+        for (area, key, ms, starting) in &w.first {
+            println!(
+                "    first {} access ({}) took {:.1} ms{}",
+                area,
+                key,
+                ms,
+                if *starting { " during startup" } else { "" }
+            );
+        }
+
+        let mut keys: Vec<_> = w.keys.iter().collect();
+        keys.sort_by(|a, b| b.1.ms.total_cmp(&a.1.ms));
+        println!(
+            "    {:>6} {:>9} {:>6} {:>9} {:>8} {:>8} {:>10}  key",
+            "reads", "read", "writes", "written", "ms", "max ms", "startup ms"
+        );
+        for ((area, key), k) in keys.iter().take(TOP_KEYS) {
+            println!(
+                "    {:>6} {:>9} {:>6} {:>9} {:>8.1} {:>8.2} {:>10.1}  {} {}",
+                k.reads,
+                bytes(k.read_bytes),
+                k.writes,
+                bytes(k.write_bytes),
+                k.ms,
+                k.max_ms,
+                k.startup_ms,
+                area,
+                key
+            );
+        }
+
+        for (area, key, size, ms, site, stack) in &w.large {
+            println!(
+                "    {} {} of {} \"{}\" read during startup ({:.1} ms) {}",
+                "warning:".yellow().bold(),
+                bytes(*size),
+                area,
+                key,
+                ms,
+                site
+            );
+            for frame in stack.iter().skip(1).take(STACK_FRAMES) {
+                println!("         {}", frame);
+            }
+        }
+        if startup_ms >= STARTUP_LIMIT_MS {
+            println!(
+                "    {} synchronous storage blocked startup for {:.1} ms; keep large state in IndexedDB or read it after load",
+                "warning:".yellow().bold(),
+                startup_ms
+            );
+        }
+    }
+}
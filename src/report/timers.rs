@@ -0,0 +1,145 @@
+//! `timers` records — timer and animation-frame call sites, busy vs idle
+//!
+//! Each record covers `span_ms` of page time, `idle_ms` of it with the page
+//! hidden or without input, and lists every registering call site that
+//! fired in it as `[site, api, fires, ms, idle_fires, idle_ms, delay]`. The
+//! time is spent inside the callbacks only.
+
+use super::{heading, num, webview_of, Report};
+use colored::Colorize;
+use serde_json::Value;
+use std::collections::{BTreeMap, HashMap};
+
+/// Idle wakeups per second from one site that look like a forgotten timer
+const IDLE_WAKEUPS_LIMIT: f64 = 1.0;
+
+/// How many sites to list per webview, and how many of those get stacks
+const TOP_SITES: usize = 10;
+const TOP_STACKS: usize = 3;
+
+#[derive(Default)]
+struct Site {
+    delay: f64,
+    fires: f64,
+    ms: f64,
+    idle_fires: f64,
+    idle_ms: f64,
+}
+
+#[derive(Default)]
+struct Webview {
+    span_ms: f64,
+    idle_ms: f64,
+    sites: HashMap<(String, String), Site>,
+    stacks: HashMap<String, Vec<String>>,
+}
+
+fn field(row: &[Value], i: usize) -> f64 {
+    row.get(i).and_then(Value::as_f64).unwrap_or(0.0)
+}
+
+pub fn print(report: &Report) {
+    let mut webviews: BTreeMap<i64, Webview> = BTreeMap::new();
+    for r in report.of_kind("timers") {
+        let w = webviews.entry(webview_of(r)).or_default();
+        w.span_ms += num(r, "span_ms");
+        w.idle_ms += num(r, "idle_ms");
+
+        let rows = r.get("sites").and_then(Value::as_array);
+        for row in rows.into_iter().flatten().filter_map(Value::as_array) {
+            let site = row.first().and_then(Value::as_str).unwrap_or("");
+            let api = row.get(1).and_then(Value::as_str).unwrap_or("");
+            let s = w
+                .sites
+                .entry((site.to_string(), api.to_string()))
+                .or_default();
+            s.fires += field(row, 2);
+            s.ms += field(row, 3);
+            s.idle_fires += field(row, 4);
+            s.idle_ms += field(row, 5);
+            s.delay = field(row, 6);
+        }
+
+        if let Some(stacks) = r.get("stacks").and_then(Value::as_object) {
+            for (site, frames) in stacks {
+                let frames = frames.as_array().into_iter().flatten();
+                w.stacks.insert(
+                    site.clone(),
+                    frames
+                        .filter_map(Value::as_str)
+                        .map(str::to_string)
+                        .collect(),
+                );
+            }
+        }
+    }
+
+    if webviews.is_empty() {
+        return;
+    }
+
+    heading("Timers");
+    for (webview, w) in webviews {
+        let idle_s = w.idle_ms / 1000.0;
+        let fires: f64 = w.sites.values().map(|s| s.fires).sum();
+        let idle_fires: f64 = w.sites.values().map(|s| s.idle_fires).sum();
+        println!(
+            "  webview {}: {} callback(s) over {:.1} s; {} of them during {:.1} s idle",
+            webview,
+            fires,
+            w.span_ms / 1000.0,
+            idle_fires,
+            idle_s
+        );
+
+        let mut sites: Vec<((String, String), Site)> = w.sites.into_iter().collect();
+        sites.sort_by(|a, b| {
+            (b.1.idle_ms, b.1.idle_fires, b.1.ms)
+                .partial_cmp(&(a.1.idle_ms, a.1.idle_fires, a.1.ms))
+                .unwrap()
+        });
+
+        println!(
+            "    {:<12} {:>7} {:>10} {:>10} {:>10}  site",
+            "api", "delay", "idle /s", "idle CPU", "total ms"
+        );
+        for (i, ((site, api), s)) in sites.iter().take(TOP_SITES).enumerate() {
+            let rate = if idle_s > 0.0 {
+                s.idle_fires / idle_s
+            } else {
+                0.0
+            };
+            let share = if w.idle_ms > 0.0 {
+                format!("{:.2}%", s.idle_ms / w.idle_ms * 100.0)
+            } else {
+                "-".to_string()
+            };
+            println!(
+                "    {:<12} {:>7} {:>10.2} {:>10} {:>10.1}  {}",
+                api,
+                if api == "rAF" {
+                    "-".to_string()
+                } else {
+                    format!("{}", s.delay)
+                },
+                rate,
+                share,
+                s.ms,
+                site
+            );
+            if i < TOP_STACKS {
+                let frames = w.stacks.get(site).map(Vec::as_slice).unwrap_or(&[]);
+                for frame in frames.iter().skip(1) {
+                    println!("         {}", frame);
+                }
+            }
+            if rate >= IDLE_WAKEUPS_LIMIT {
+                println!(
+                    "      {} wakes the idle page {:.1} time(s) a second",
+                    "warning:".yellow().bold(),
+                    rate
+                );
+            }
+        }
+    }
+}
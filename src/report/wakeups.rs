@@ -0,0 +1,107 @@
+//! `wakeups` records — GTK main-loop wakeups by cause, powertop style
+//!
+//! libspy writes one record roughly per second of main-loop activity,
+//! covering `span_us`, with wakeup counts per cause, the main thread's and
+//! the whole process's CPU time, and the descriptors that woke the loop most.
+
+use super::{heading, num, webview_of, Report};
+use colored::Colorize;
+use serde_json::Value;
+use std::collections::HashMap;
+
+/// Wakeups per second that keep a laptop CPU out of deep idle states
+const WAKEUPS_LIMIT: f64 = 100.0;
+
+/// Causes in report order: record field and description
+const CAUSES: &[(&str, &str)] = &[
+    ("fd", "file descriptor ready"),
+    ("timer", "timer expired"),
+    ("ready", "source already pending (idle)"),
+    ("spin", "non-blocking iteration, nothing to do"),
+    ("interrupted", "poll interrupted by a signal"),
+];
+
+/// How many descriptors to list
+const TOP_FDS: usize = 8;
+
+pub fn print(report: &Report) {
+    let records: Vec<&Value> = report
+        .of_kind("wakeups")
+        .filter(|r| webview_of(r) < 0)
+        .collect();
+    if records.is_empty() {
+        return;
+    }
+
+    let seconds: f64 = records.iter().map(|r| num(r, "span_us")).sum::<f64>() / 1e6;
+    let sum = |field: &str| records.iter().map(|r| num(r, field)).sum::<f64>();
+    let per_second = |n: f64| if seconds > 0.0 { n / seconds } else { 0.0 };
+
+    heading("Main-loop wakeups");
+    let total: f64 = CAUSES.iter().map(|(field, _)| sum(field)).sum();
+    println!(
+        "  {:.1} wakeups/s over {:.1} s; main thread {:.1}% CPU, process {:.1}% CPU, waiting {:.1}% of the time",
+        per_second(total),
+        seconds,
+        per_second(sum("main_cpu_us")) / 1e4,
+        per_second(sum("process_cpu_us")) / 1e4,
+        per_second(sum("sleep_us")) / 1e4
+    );
+
+    println!("    {:>10} {:>7}  cause", "wakeups/s", "share");
+    for (field, description) in CAUSES {
+        let n = sum(field);
+        if n == 0.0 {
+            continue;
+        }
+        println!(
+            "    {:>10.1} {:>6.1}%  {}",
+            per_second(n),
+            n / total * 100.0,
+            description
+        );
+    }
+
+    // Descriptors, named by /proc when the record was written
+    let mut fds: HashMap<(u64, String), f64> = HashMap::new();
+    for r in &records {
+        let rows = r.get("fds").and_then(Value::as_array);
+        for row in rows.into_iter().flatten().filter_map(Value::as_array) {
+            let fd = row.first().and_then(Value::as_u64).unwrap_or(0);
+            let label = row.get(2).and_then(Value::as_str).unwrap_or("?");
+            let hits = row.get(1).and_then(Value::as_f64).unwrap_or(0.0);
+            *fds.entry((fd, label.to_string())).or_default() += hits;
+        }
+    }
+    if !fds.is_empty() {
+        let mut fds: Vec<((u64, String), f64)> = fds.into_iter().collect();
+        fds.sort_by(|a, b| b.1.total_cmp(&a.1));
+        println!("    {:>10} {:>7}  descriptor", "wakeups/s", "fd");
+        for ((fd, label), hits) in fds.iter().take(TOP_FDS) {
+            println!("    {:>10.1} {:>7}  {}", per_second(*hits), fd, label);
+        }
+    }
+
+    let blocking = sum("blocking_iterations");
+    let nonblocking = sum("nonblocking_iterations");
+    if blocking + nonblocking > 0.0 {
+        println!(
+            "    gtk_main_iteration_do(): {:.1}/s blocking, {:.1}/s non-blocking",
+            per_second(blocking),
+            per_second(nonblocking)
+        );
+    }
+
+    if per_second(sum("spin")) >= WAKEUPS_LIMIT {
+        println!(
+            "    {} the event loop is busy-polling with non-blocking iterations",
+            "warning:".yellow().bold()
+        );
+    } else if per_second(total) >= WAKEUPS_LIMIT {
+        println!(
+            "    {} over {} wakeups/s keeps the CPU out of deep idle",
+            "warning:".yellow().bold(),
+            WAKEUPS_LIMIT
+        );
+    }
+}
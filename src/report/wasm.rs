@@ -0,0 +1,113 @@
+//! `wasm` records — WebAssembly compile and instantiate during startup
+//!
+//! One record per compile or instantiate call once it settled, with the
+//! module size, the time of each phase and how it was done: streaming while
+//! downloading, from a buffer, or synchronously through the Module and
+//! Instance constructors.
+
+use super::{bytes, heading, num, text, webview_of, Report};
+use colored::Colorize;
+use serde_json::Value;
+use std::collections::BTreeMap;
+
+/// Modules at least this large should be compiled while downloading
+const STREAMING_SIZE: f64 = 1024.0 * 1024.0;
+
+/// A synchronous compile or instantiate this long is a long task
+const SYNC_LIMIT_MS: f64 = 50.0;
+
+fn ms(record: &Value, field: &str) -> Option<f64> {
+    record.get(field).and_then(Value::as_f64)
+}
+
+fn flag(record: &Value, field: &str) -> bool {
+    record.get(field).and_then(Value::as_bool).unwrap_or(false)
+}
+
+fn column(value: Option<f64>) -> String {
+    value.map_or("-".to_string(), |v| format!("{:.1}", v))
+}
+
+pub fn print(report: &Report) {
+    let mut webviews: BTreeMap<i64, Vec<&Value>> = BTreeMap::new();
+    for r in report.of_kind("wasm") {
+        webviews.entry(webview_of(r)).or_default().push(r);
+    }
+    if webviews.is_empty() {
+        return;
+    }
+
+    heading("WebAssembly");
+    for (webview, calls) in webviews {
+        let compile_ms: f64 = calls.iter().filter_map(|r| ms(r, "compile_ms")).sum();
+        let instantiate_ms: f64 = calls.iter().filter_map(|r| ms(r, "instantiate_ms")).sum();
+        println!(
+            "  webview {}: {} call(s), {:.1} ms compiling, {:.1} ms instantiating",
+            webview,
+            calls.len(),
+            compile_ms,
+            instantiate_ms
+        );
+        println!(
+            "    {:>9} {:>20} {:>9} {:>10} {:>10} {:>9}  module",
+            "at", "api", "size", "compile ms", "inst ms", "mode"
+        );
+        for r in &calls {
+            let size = r.get("bytes").and_then(Value::as_f64);
+            let mode = if flag(r, "sync") {
+                "sync"
+            } else if flag(r, "streaming") {
+                "streaming"
+            } else {
+                "buffered"
+            };
+            let module = match text(r, "url") {
+                "" => text(r, "site"),
+                url => url,
+            };
+            println!(
+                "    {:>7.1}ms {:>20} {:>9} {:>10} {:>10} {:>9}  {}",
+                num(r, "started_ms"),
+                text(r, "api"),
+                size.map_or("-".to_string(), bytes),
+                column(ms(r, "compile_ms")),
+                column(ms(r, "instantiate_ms")),
+                mode,
+                module
+            );
+            if let Some(error) = r.get("error").and_then(Value::as_str) {
+                println!("              {} {}", "failed:".red().bold(), error);
+            }
+        }
+
+        for r in &calls {
+            let size = num(r, "bytes");
+            let failed = r.get("error").and_then(Value::as_str).is_some();
+            if flag(r, "streaming") && failed {
+                println!(
+                    "    {} {} failed to stream; serve .wasm as application/wasm so it compiles while downloading",
+                    "warning:".yellow().bold(),
+                    text(r, "api")
+                );
+            } else if flag(r, "sync") {
+                let took = ms(r, "compile_ms")
+                    .or(ms(r, "instantiate_ms"))
+                    .unwrap_or(0.0);
+                if took >= SYNC_LIMIT_MS {
+                    println!(
+                        "    {} new WebAssembly.{}() blocked the main thread for {:.1} ms",
+                        "warning:".yellow().bold(),
+                        text(r, "api"),
+                        took
+                    );
+                }
+            } else if !flag(r, "streaming") && size >= STREAMING_SIZE {
+                println!(
+                    "    {} {} of wasm compiled from a buffer; instantiateStreaming() overlaps compiling with the download",
+                    "note:".cyan().bold(),
+                    bytes(size)
+                );
+            }
+        }
+    }
+}
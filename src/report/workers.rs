@@ -0,0 +1,140 @@
+//! `worker_created`, `worker_terminated` and `workers` records — traffic
+//! between the page and its Web Workers
+//!
+//! Each `workers` record covers one second as `[worker, url, sent,
+//! sent_bytes, clone_ms, max_clone_ms, transferred_bytes,
+//! copied_buffer_bytes, received, received_bytes, latency_ms,
+//! max_latency_ms]` rows. Sizes are the probe's estimates of the cloned
+//! payload; clone time is measured around postMessage() at the sender.
+
+use super::{bytes, heading, num, text, webview_of, Report};
+use colored::Colorize;
+use serde_json::Value;
+use std::collections::BTreeMap;
+
+/// Copied ArrayBuffer bytes that should have been transferred
+const COPY_LIMIT: f64 = 1024.0 * 1024.0;
+
+/// Share of a second spent cloning before it dominates the main thread
+const CLONE_SHARE_LIMIT: f64 = 0.1;
+
+#[derive(Default)]
+struct Worker {
+    url: String,
+    site: String,
+    terminated: Option<f64>,
+    seconds: f64,
+    sent: f64,
+    sent_bytes: f64,
+    clone_ms: f64,
+    max_clone_ms: f64,
+    transferred_bytes: f64,
+    copied_bytes: f64,
+    received: f64,
+    received_bytes: f64,
+    latency_ms: f64,
+    max_latency_ms: f64,
+}
+
+pub fn print(report: &Report) {
+    let mut webviews: BTreeMap<i64, BTreeMap<i64, Worker>> = BTreeMap::new();
+    for r in report.of_kind("worker_created") {
+        let w = webviews.entry(webview_of(r)).or_default();
+        let worker = w.entry(num(r, "worker") as i64).or_default();
+        worker.url = text(r, "url").to_string();
+        worker.site = text(r, "site").to_string();
+    }
+    for r in report.of_kind("worker_terminated") {
+        let w = webviews.entry(webview_of(r)).or_default();
+        w.entry(num(r, "worker") as i64).or_default().terminated = Some(num(r, "lifetime_ms"));
+    }
+    for r in report.of_kind("workers") {
+        let w = webviews.entry(webview_of(r)).or_default();
+        let rows = r.get("items").and_then(Value::as_array);
+        for row in rows.into_iter().flatten().filter_map(Value::as_array) {
+            let cell = |i: usize| row.get(i).and_then(Value::as_f64).unwrap_or(0.0);
+            let worker = w.entry(cell(0) as i64).or_default();
+            if worker.url.is_empty() {
+                worker.url = row
+                    .get(1)
+                    .and_then(Value::as_str)
+                    .unwrap_or("?")
+                    .to_string();
+            }
+            worker.seconds += 1.0;
+            worker.sent += cell(2);
+            worker.sent_bytes += cell(3);
+            worker.clone_ms += cell(4);
+            worker.max_clone_ms = worker.max_clone_ms.max(cell(5));
+            worker.transferred_bytes += cell(6);
+            worker.copied_bytes += cell(7);
+            worker.received += cell(8);
+            worker.received_bytes += cell(9);
+            worker.latency_ms += cell(10);
+            worker.max_latency_ms = worker.max_latency_ms.max(cell(11));
+        }
+    }
+    if webviews.is_empty() {
+        return;
+    }
+
+    heading("Web Workers");
+    for (webview, workers) in webviews {
+        let terminated = workers.values().filter(|w| w.terminated.is_some()).count();
+        println!(
+            "  webview {}: {} worker(s) created, {} terminated",
+            webview,
+            workers.len(),
+            terminated
+        );
+        for (id, w) in &workers {
+            println!(
+                "    worker {} {}{}",
+                id,
+                w.url,
+                match w.terminated {
+                    Some(ms) => format!(" (terminated after {:.1} s)", ms / 1000.0),
+                    None => String::new(),
+                }
+            );
+            if !w.site.is_empty() {
+                println!("      created {}", w.site);
+            }
+            if w.sent == 0.0 && w.received == 0.0 {
+                continue;
+            }
+            println!(
+                "      sent     {} message(s), {}; clone {:.1} ms (avg {:.3}, max {:.2}); transferred {}, copied buffers {}",
+                w.sent,
+                bytes(w.sent_bytes),
+                w.clone_ms,
+                w.clone_ms / w.sent.max(1.0),
+                w.max_clone_ms,
+                bytes(w.transferred_bytes),
+                bytes(w.copied_bytes)
+            );
+            println!(
+                "      received {} message(s), {}; queued {:.2} ms avg, {:.1} ms max",
+                w.received,
+                bytes(w.received_bytes),
+                w.latency_ms / w.received.max(1.0),
+                w.max_latency_ms
+            );
+
+            if w.copied_bytes >= COPY_LIMIT {
+                println!(
+                    "      {} {} of ArrayBuffers were copied; pass them in the transfer list",
+                    "warning:".yellow().bold(),
+                    bytes(w.copied_bytes)
+                );
+            }
+            if w.seconds > 0.0 && w.clone_ms / (w.seconds * 1000.0) >= CLONE_SHARE_LIMIT {
+                println!(
+                    "      {} cloning messages took {:.1}% of the main thread while active",
+                    "warning:".yellow().bold(),
+                    w.clone_ms / (w.seconds * 10.0)
+                );
+            }
+        }
+    }
+}
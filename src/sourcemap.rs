@@ -0,0 +1,484 @@
+//! Source maps for the JS stack frames libspy records
+//!
+//! Page probes record frames the way WebKit prints them,
+//! `fn@tauri://localhost/assets/index-3f2a.js:1:48213`, which says little
+//! about a minified release bundle. A [`Resolver`] maps each frame back to
+//! its original source through a source map found either in a directory
+//! (`--source-maps`) or in the `srcmap` records written by the
+//! `source-maps` probe, which fetches the maps through the app's own asset
+//! scheme.
+//!
+//! A map's `mappings` are VLQ-decoded once, on the first frame that needs
+//! it, into per-line segment tables searched by binary search. Resolved
+//! frames are cached by their text, so a report repeating the same few
+//! thousand frames millions of times costs a hash lookup per frame.
+
+use serde_json::Value;
+use std::collections::HashMap;
+use std::fs;
+use std::path::{Path, PathBuf};
+
+/// One mapped position: generated column to original source, line, column
+#[derive(Clone, Copy)]
+struct Segment {
+    column: u32,
+    source: u32,
+    line: u32,
+    source_column: u32,
+}
+
+/// A decoded source map (sections of an index map flattened into one)
+pub struct SourceMap {
+    sources: Vec<String>,
+    lines: Vec<Vec<Segment>>,
+}
+
+fn base64_digit(byte: u8) -> Option<i64> {
+    match byte {
+        b'A'..=b'Z' => Some((byte - b'A') as i64),
+        b'a'..=b'z' => Some((byte - b'a') as i64 + 26),
+        b'0'..=b'9' => Some((byte - b'0') as i64 + 52),
+        b'+' => Some(62),
+        b'/' => Some(63),
+        _ => None,
+    }
+}
+
+/// Decode the VLQ fields of one segment, e.g. "AAgBC" -> [0, 0, 16, 1]
+fn decode_segment(segment: &[u8], fields: &mut Vec<i64>) -> Result<(), String> {
+    fields.clear();
+    let mut value: i64 = 0;
+    let mut shift = 0;
+    for &byte in segment {
+        let digit = base64_digit(byte)
+            .ok_or_else(|| format!("invalid character {:?} in mappings", byte as char))?;
+        value += (digit & 31) << shift;
+        if digit & 32 != 0 {
+            shift += 5;
+            if shift > 60 {
+                return Err("VLQ value too long in mappings".to_string());
+            }
+            continue;
+        }
+        fields.push(if value & 1 != 0 {
+            -(value >> 1)
+        } else {
+            value >> 1
+        });
+        value = 0;
+        shift = 0;
+    }
+    if shift != 0 {
+        return Err("truncated VLQ value in mappings".to_string());
+    }
+    Ok(())
+}
+
+impl SourceMap {
+    pub fn parse(text: &str) -> Result<SourceMap, String> {
+        let json: Value =
+            serde_json::from_str(text).map_err(|e| format!("not a source map: {}", e))?;
+        let mut map = SourceMap {
+            sources: Vec::new(),
+            lines: Vec::new(),
+        };
+        map.add(&json, 0, 0)?;
+        for line in &mut map.lines {
+            line.sort_by_key(|s| s.column);
+        }
+        Ok(map)
+    }
+
+    /// Add a map (or an index map's sections) whose generated code starts at
+    /// the given line and column
+    fn add(&mut self, json: &Value, line_offset: u32, column_offset: u32) -> Result<(), String> {
+        if let Some(sections) = json.get("sections").and_then(Value::as_array) {
+            for section in sections {
+                let offset = section.get("offset");
+                let at = |field: &str| {
+                    offset
+                        .and_then(|o| o.get(field))
+                        .and_then(Value::as_u64)
+                        .unwrap_or(0) as u32
+                };
+                if let Some(map) = section.get("map") {
+                    self.add(map, line_offset + at("line"), column_offset + at("column"))?;
+                }
+            }
+            return Ok(());
+        }
+
+        let root = json.get("sourceRoot").and_then(Value::as_str).unwrap_or("");
+        let first_source = self.sources.len() as u32;
+        let sources = json.get("sources").and_then(Value::as_array);
+        for source in sources.into_iter().flatten() {
+            let source = source.as_str().unwrap_or("?");
+            self.sources
+                .push(if root.is_empty() || source.contains("://") {
+                    source.to_string()
+                } else {
+                    format!("{}/{}", root.trim_end_matches('/'), source)
+                });
+        }
+
+        let mappings = json.get("mappings").and_then(Value::as_str).unwrap_or("");
+        let mut fields = Vec::with_capacity(5);
+        let (mut source, mut line, mut source_column) = (0i64, 0i64, 0i64);
+        for (n, generated) in mappings.split(';').enumerate() {
+            let line_index = line_offset as usize + n;
+            let mut column = if n == 0 { column_offset as i64 } else { 0 };
+            for segment in generated.split(',').filter(|s| !s.is_empty()) {
+                decode_segment(segment.as_bytes(), &mut fields)?;
+                column += fields[0];
+                if fields.len() < 4 {
+                    continue;
+                }
+                source += fields[1];
+                line += fields[2];
+                source_column += fields[3];
+                if column < 0 || source < 0 || line < 0 || source_column < 0 {
+                    return Err("negative position in mappings".to_string());
+                }
+                if self.lines.len() <= line_index {
+                    self.lines.resize_with(line_index + 1, Vec::new);
+                }
+                self.lines[line_index].push(Segment {
+                    column: column as u32,
+                    source: first_source + source as u32,
+                    line: line as u32,
+                    source_column: source_column as u32,
+                });
+            }
+        }
+        Ok(())
+    }
+
+    /// Original source, line and column (all 0-based) of a generated position
+    pub fn lookup(&self, line: u32, column: u32) -> Option<(&str, u32, u32)> {
+        let segments = self.lines.get(line as usize)?;
+        let after = segments.partition_point(|s| s.column <= column);
+        let segment = segments.get(after.checked_sub(1)?)?;
+        let source = self.sources.get(segment.source as usize)?;
+        Some((source, segment.line, segment.source_column))
+    }
+}
+
+/// Split a frame into (text before the location, script URL, line, column).
+/// Accepts WebKit's `fn@url:1:2` and `url:1:2`, and V8's `at fn (url:1:2)`.
+fn split_frame(frame: &str) -> Option<(&str, &str, u32, u32)> {
+    let location = frame.trim_end_matches(')');
+    let (rest, column) = location.rsplit_once(':')?;
+    let (rest, line) = rest.rsplit_once(':')?;
+    let column = column.parse().ok()?;
+    let line = line.parse().ok()?;
+
+    // WebKit's name ends at the first '@'; one after a '/' is part of the
+    // URL (`/@vite/client`, `/node_modules/@scope/pkg`)
+    let start = rest
+        .find('@')
+        .filter(|&i| !rest[..i].contains('/'))
+        .or_else(|| rest.rfind('('))
+        .map(|i| i + 1)
+        .unwrap_or_else(|| if rest.starts_with("at ") { 3 } else { 0 });
+    Some((&frame[..start], &rest[start..], line, column))
+}
+
+/// Fold a value into one already under the same key: counts add up,
+/// anything else (stacks, labels) keeps the first
+fn merge(into: &mut Value, other: Value) {
+    if let (Some(a), Some(b)) = (into.as_u64(), other.as_u64()) {
+        *into = Value::from(a + b);
+    } else if let (Some(a), Some(b)) = (into.as_f64(), other.as_f64()) {
+        *into = Value::from(a + b);
+    }
+}
+
+/// The path part of a script URL, without query or fragment
+fn url_path(url: &str) -> &str {
+    let url = url.split(['?', '#']).next().unwrap_or(url);
+    match url.split_once("://") {
+        Some((_, rest)) => rest.find('/').map(|i| &rest[i..]).unwrap_or("/"),
+        None => url,
+    }
+}
+
+/// Resolves recorded frames through source maps, caching maps and frames
+pub struct Resolver {
+    dir: Option<PathBuf>,
+    /// Map text from `srcmap` records, by script URL (without query)
+    recorded: HashMap<String, String>,
+    maps: HashMap<String, Option<SourceMap>>,
+    frames: HashMap<String, Option<String>>,
+    pub errors: Vec<String>,
+}
+
+impl Resolver {
+    pub fn new(dir: Option<&Path>) -> Resolver {
+        Resolver {
+            dir: dir.map(Path::to_path_buf),
+            recorded: HashMap::new(),
+            maps: HashMap::new(),
+            frames: HashMap::new(),
+            errors: Vec::new(),
+        }
+    }
+
+    /// Use a map fetched by the page for the script at `url`
+    pub fn add_recorded(&mut self, url: &str, map: &str) {
+        let url = url.split(['?', '#']).next().unwrap_or(url);
+        self.recorded.insert(url.to_string(), map.to_string());
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.dir.is_none() && self.recorded.is_empty()
+    }
+
+    /// Maps loaded so far
+    pub fn maps_loaded(&self) -> usize {
+        self.maps.values().filter(|m| m.is_some()).count()
+    }
+
+    /// Candidate map files in the source-map directory for a script path:
+    /// the same relative path plus ".map", the file name plus ".map", and
+    /// whatever a copy of the script names in its sourceMappingURL comment
+    fn candidates(dir: &Path, path: &str) -> Vec<PathBuf> {
+        let relative = path.trim_start_matches('/');
+        let name = relative.rsplit('/').next().unwrap_or(relative);
+        let mut candidates = vec![
+            dir.join(format!("{}.map", relative)),
+            dir.join(format!("{}.map", name)),
+        ];
+        for script in [dir.join(relative), dir.join(name)] {
+            let Ok(source) = fs::read_to_string(&script) else {
+                continue;
+            };
+            let comment = source
+                .lines()
+                .rev()
+                .find_map(|l| l.trim().strip_prefix("//# sourceMappingURL="));
+            if let Some(url) = comment.filter(|u| !u.contains(':')) {
+                candidates.push(script.parent().unwrap_or(dir).join(url.trim()));
+            }
+        }
+        candidates
+    }
+
+    fn load(&mut self, url: &str) -> Option<SourceMap> {
+        let mut found = self
+            .recorded
+            .remove(url)
+            .map(|text| (url.to_string(), text));
+        if found.is_none() {
+            if let Some(dir) = &self.dir {
+                found = Self::candidates(dir, url_path(url))
+                    .into_iter()
+                    .find_map(|p| Some((p.display().to_string(), fs::read_to_string(&p).ok()?)));
+            }
+        }
+
+        let (origin, text) = found?;
+        match SourceMap::parse(&text) {
+            Ok(map) => Some(map),
+            Err(e) => {
+                self.errors.push(format!("{}: {}", origin, e));
+                None
+            }
+        }
+    }
+
+    /// The source map for a script URL, loaded on first use
+    pub fn map(&mut self, url: &str) -> Option<&SourceMap> {
+        let url = url.split(['?', '#']).next().unwrap_or(url);
+        if !self.maps.contains_key(url) {
+            let map = self.load(url);
+            self.maps.insert(url.to_string(), map);
+        }
+        self.maps[url].as_ref()
+    }
+
+    /// The frame with its location mapped to the original source, if a map
+    /// covers it
+    pub fn resolve(&mut self, frame: &str) -> Option<String> {
+        if let Some(cached) = self.frames.get(frame) {
+            return cached.clone();
+        }
+
+        // Anything else (kinds, labels, URLs) is neither resolved nor cached
+        let (prefix, url, line, column) = split_frame(frame)?;
+        let resolved = self.map(url).and_then(|map| {
+            let (source, line, column) =
+                map.lookup(line.checked_sub(1)?, column.saturating_sub(1))?;
+            let close = if prefix.ends_with('(') { ")" } else { "" };
+            Some(format!(
+                "{}{}:{}:{}{}",
+                prefix,
+                source,
+                line + 1,
+                column + 1,
+                close
+            ))
+        });
+        self.frames.insert(frame.to_string(), resolved.clone());
+        resolved
+    }
+
+    /// Rewrite every frame-looking string in a record, including object keys
+    /// (per-site `stacks` objects). Returns how many strings changed.
+    pub fn rewrite(&mut self, value: &mut Value) -> usize {
+        match value {
+            Value::String(s) => match self.resolve(s) {
+                Some(resolved) => {
+                    *s = resolved;
+                    1
+                }
+                None => 0,
+            },
+            Value::Array(items) => items.iter_mut().map(|v| self.rewrite(v)).sum(),
+            Value::Object(fields) => {
+                let mut changed = 0;
+                let old = std::mem::take(fields);
+                for (key, mut field) in old {
+                    changed += self.rewrite(&mut field);
+                    let key = match self.resolve(&key) {
+                        Some(resolved) => {
+                            changed += 1;
+                            resolved
+                        }
+                        None => key,
+                    };
+                    // Minified sites can resolve to the same original one
+                    match fields.get_mut(&key) {
+                        Some(existing) => merge(existing, field),
+                        None => {
+                            fields.insert(key, field);
+                        }
+                    }
+                }
+                changed
+            }
+            _ => 0,
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use serde_json::json;
+
+    /// Two sources; line 1 carries source line and column over from line 0,
+    /// line 2 moves back with negative deltas
+    const MAP: &str = r#"{
+        "version": 3,
+        "sources": ["a.ts", "b.ts"],
+        "names": [],
+        "mappings": "AAAA,KAAK;AACA,SCAG;ADDD"
+    }"#;
+
+    const URL: &str = "tauri://localhost/assets/@vite/index.js";
+
+    fn decode(segment: &str) -> Vec<i64> {
+        let mut fields = Vec::new();
+        decode_segment(segment.as_bytes(), &mut fields).unwrap();
+        fields
+    }
+
+    #[test]
+    fn decodes_vlq_segments() {
+        assert_eq!(decode("AAgBC"), vec![0, 0, 16, 1]);
+        assert_eq!(decode("D"), vec![-1]);
+        assert_eq!(decode("2H"), vec![123]);
+        assert_eq!(decode("3H"), vec![-123]);
+        let mut fields = Vec::new();
+        assert!(decode_segment(b"g", &mut fields).is_err());
+        assert!(decode_segment(b"A!", &mut fields).is_err());
+    }
+
+    #[test]
+    fn looks_up_positions_across_lines() {
+        let map = SourceMap::parse(MAP).unwrap();
+        assert_eq!(map.lookup(0, 0), Some(("a.ts", 0, 0)));
+        assert_eq!(map.lookup(0, 7), Some(("a.ts", 0, 5)));
+        assert_eq!(map.lookup(1, 0), Some(("a.ts", 1, 5)));
+        assert_eq!(map.lookup(1, 20), Some(("b.ts", 1, 8)));
+        assert_eq!(map.lookup(2, 3), Some(("a.ts", 0, 7)));
+        assert_eq!(map.lookup(3, 0), None);
+    }
+
+    #[test]
+    fn rejects_negative_positions() {
+        let map = r#"{"sources": ["a.ts"], "mappings": "AAAD"}"#;
+        assert!(SourceMap::parse(map).is_err());
+    }
+
+    #[test]
+    fn flattens_index_map_sections() {
+        let map = r#"{
+            "version": 3,
+            "sections": [
+                {"offset": {"line": 0, "column": 0},
+                 "map": {"sources": ["x.ts"], "mappings": "AAAA"}},
+                {"offset": {"line": 3, "column": 10},
+                 "map": {"sourceRoot": "src/", "sources": ["y.ts"],
+                         "mappings": "AAAA,EAAE;AACA"}}
+            ]
+        }"#;
+        let map = SourceMap::parse(map).unwrap();
+        assert_eq!(map.lookup(0, 100), Some(("x.ts", 0, 0)));
+        assert_eq!(map.lookup(3, 5), None);
+        assert_eq!(map.lookup(3, 11), Some(("src/y.ts", 0, 0)));
+        assert_eq!(map.lookup(3, 12), Some(("src/y.ts", 0, 2)));
+        assert_eq!(map.lookup(4, 0), Some(("src/y.ts", 1, 2)));
+    }
+
+    #[test]
+    fn splits_frames_with_at_signs_in_urls() {
+        assert_eq!(
+            split_frame("render@tauri://localhost/@vite/client:1:8"),
+            Some(("render@", "tauri://localhost/@vite/client", 1, 8))
+        );
+        assert_eq!(
+            split_frame("tauri://localhost/node_modules/@scope/pkg.js:3:4"),
+            Some(("", "tauri://localhost/node_modules/@scope/pkg.js", 3, 4))
+        );
+        assert_eq!(
+            split_frame("at fn (/node_modules/.vite/deps/@tauri-apps_api.js:5:6)"),
+            Some((
+                "at fn (",
+                "/node_modules/.vite/deps/@tauri-apps_api.js",
+                5,
+                6
+            ))
+        );
+        assert_eq!(split_frame("global code"), None);
+    }
+
+    #[test]
+    fn resolves_frames() {
+        let mut resolver = Resolver::new(None);
+        resolver.add_recorded(URL, MAP);
+        let frame = format!("fn@{}:1:8", URL);
+        assert_eq!(resolver.resolve(&frame).as_deref(), Some("fn@a.ts:1:6"));
+        let frame = format!("{}:2:21", URL);
+        assert_eq!(resolver.resolve(&frame).as_deref(), Some("b.ts:2:9"));
+        let frame = format!("at fn ({}:1:8)", URL);
+        assert_eq!(
+            resolver.resolve(&frame).as_deref(),
+            Some("at fn (a.ts:1:6)")
+        );
+    }
+
+    #[test]
+    fn merges_keys_that_resolve_to_the_same_site() {
+        let mut resolver = Resolver::new(None);
+        resolver.add_recorded(URL, MAP);
+        let (a, b) = (format!("fn@{}:1:7", URL), format!("fn@{}:1:8", URL));
+        let mut record = json!({
+            "calls": {a.clone(): 2, b.clone(): 3},
+            "stacks": {a: ["first"], b: ["second"]},
+        });
+        assert_eq!(resolver.rewrite(&mut record), 4);
+        assert_eq!(record["calls"], json!({"fn@a.ts:1:6": 5}));
+        assert_eq!(record["stacks"], json!({"fn@a.ts:1:6": ["first"]}));
+    }
+}
@@ -0,0 +1,375 @@
+//! `tauri-spy startup` — where the JS part of a page load goes, per script
+//!
+//! The target is launched with WebKitGTK's remote inspector on a local port.
+//! Once its page is up, the page is reloaded with the Network, Timeline and
+//! ScriptProfiler domains recording, until the load event plus a settle
+//! time. All three stamp their events with the same inspector stopwatch.
+//!
+//! For each script: its size and serve time from the asset scheme
+//! (`Network` request to `loadingFinished`), when its top-level evaluation
+//! started, how long that took (`EvaluateScript` timeline records), and how
+//! much of it was JavaScript running according to the sampling profiler.
+//! JSC reports no parse or compile events, so the rest of the evaluate
+//! window is what parsing and bytecode compilation cost. Module scripts get
+//! no `EvaluateScript` record; their top-level time comes from samples
+//! alone and parse/compile is not known.
+//!
+//! The measured load is a reload with the cache bypassed, so asset serving
+//! is as cold as the app allows, but JSC may still have code cached in
+//! memory from the first load.
+
+use crate::inspector::{self, Inspector};
+use crate::report::{bytes, heading};
+use colored::Colorize;
+use serde_json::{json, Value};
+use std::collections::HashMap;
+use std::process::Command;
+use std::time::{Duration, Instant};
+
+/// How long to wait for the app to show its first page
+const LAUNCH_TIMEOUT: Duration = Duration::from_secs(30);
+
+/// How long to wait for the reloaded page's load event
+const LOAD_TIMEOUT: Duration = Duration::from_secs(60);
+
+/// How long to wait for the profiler's samples after stopping it
+const SAMPLES_TIMEOUT: Duration = Duration::from_secs(10);
+
+/// Sampling interval assumed when too few samples arrive to measure it
+const DEFAULT_SAMPLE_S: f64 = 0.001;
+
+/// Parse/compile time of one script worth a warning
+const SLOW_PARSE_MS: f64 = 50.0;
+
+pub struct Options {
+    pub port: u16,
+    pub settle: u64,
+}
+
+#[derive(Default)]
+struct Script {
+    requested: Option<f64>,
+    finished: Option<f64>,
+    bytes: f64,
+    /// (start, end) of each top-level evaluation, in seconds
+    evaluations: Vec<(f64, f64)>,
+    /// Samples inside this script's evaluations
+    eval_samples: usize,
+    /// Samples rooted in this script's top-level code (module scripts)
+    top_level_samples: usize,
+}
+
+/// What one recorded page load comes down to
+struct Load {
+    scripts: HashMap<String, Script>,
+    navigation_start: Option<f64>,
+    /// Profiler sampling interval, in seconds
+    interval: f64,
+}
+
+fn method(event: &Value) -> &str {
+    event.get("method").and_then(Value::as_str).unwrap_or("")
+}
+
+fn seconds(value: &Value, field: &str) -> Option<f64> {
+    value.get(field).and_then(Value::as_f64)
+}
+
+/// EvaluateScript records, including those nested in other records
+fn evaluations(record: &Value, out: &mut Vec<(String, f64, f64)>) {
+    if record.get("type").and_then(Value::as_str) == Some("EvaluateScript") {
+        let url = record.pointer("/data/url").and_then(Value::as_str);
+        let start = seconds(record, "startTime");
+        let end = seconds(record, "endTime");
+        if let (Some(url), Some(start), Some(end)) = (url, start, end) {
+            if !url.is_empty() {
+                out.push((url.to_string(), start, end));
+            }
+        }
+    }
+    let children = record.get("children").and_then(Value::as_array);
+    for child in children.into_iter().flatten() {
+        evaluations(child, out);
+    }
+}
+
+/// Record one page load of the target behind `path`
+fn record_load(addr: &str, path: &str, settle: Duration) -> Result<Vec<Value>, String> {
+    let mut inspector = Inspector::connect(addr, path)?;
+    inspector.call("Network.enable", json!({}))?;
+    inspector.call("Page.enable", json!({}))?;
+    inspector.call("Timeline.start", json!({}))?;
+    inspector.call(
+        "ScriptProfiler.startTracking",
+        json!({ "includeSamples": true }),
+    )?;
+    inspector.events.clear();
+    inspector.call("Page.reload", json!({ "ignoreCache": true }))?;
+
+    let mut events = Vec::new();
+    let mut deadline = Instant::now() + LOAD_TIMEOUT;
+    let mut loaded = false;
+    while let Some(wait) = deadline.checked_duration_since(Instant::now()) {
+        let Some(event) = inspector.next_event(wait)? else {
+            continue;
+        };
+        if method(&event) == "Page.loadEventFired" && !loaded {
+            loaded = true;
+            deadline = Instant::now() + settle;
+        }
+        events.push(event);
+    }
+    if !loaded {
+        return Err("The page did not finish loading".to_string());
+    }
+
+    inspector.call("ScriptProfiler.stopTracking", json!({}))?;
+    inspector.call("Timeline.stop", json!({}))?;
+    let deadline = Instant::now() + SAMPLES_TIMEOUT;
+    while let Some(wait) = deadline.checked_duration_since(Instant::now()) {
+        let Some(event) = inspector.next_event(wait)? else {
+            break;
+        };
+        let complete = method(&event) == "ScriptProfiler.trackingComplete";
+        events.push(event);
+        if complete {
+            break;
+        }
+    }
+    Ok(events)
+}
+
+/// Per-script breakdown of a recorded load
+fn analyze(events: &[Value]) -> Load {
+    let mut scripts: HashMap<String, Script> = HashMap::new();
+    let mut requests: HashMap<String, String> = HashMap::new();
+    let mut navigation_start = None;
+    let mut samples: Vec<(f64, Vec<(String, String)>)> = Vec::new();
+
+    for event in events {
+        let params = &event["params"];
+        let request = params["requestId"].as_str().unwrap_or("").to_string();
+        match method(event) {
+            "Network.requestWillBeSent" => {
+                let url = params.pointer("/request/url").and_then(Value::as_str);
+                let kind = params["type"].as_str().unwrap_or("");
+                let Some(url) = url else { continue };
+                if kind == "Document" && navigation_start.is_none() {
+                    navigation_start = seconds(params, "timestamp");
+                }
+                if kind == "Script" || url.ends_with(".js") || url.ends_with(".mjs") {
+                    let script = scripts.entry(url.to_string()).or_default();
+                    script.requested = seconds(params, "timestamp");
+                    requests.insert(request, url.to_string());
+                }
+            }
+            "Network.dataReceived" => {
+                if let Some(script) = requests.get(&request).and_then(|u| scripts.get_mut(u)) {
+                    script.bytes += params["dataLength"].as_f64().unwrap_or(0.0);
+                }
+            }
+            "Network.loadingFinished" => {
+                if let Some(script) = requests.get(&request).and_then(|u| scripts.get_mut(u)) {
+                    script.finished = seconds(params, "timestamp");
+                    let received = params
+                        .pointer("/metrics/responseBodyBytesReceived")
+                        .and_then(Value::as_f64);
+                    if let Some(received) = received.filter(|&b| b > 0.0) {
+                        script.bytes = received;
+                    }
+                }
+            }
+            "Timeline.eventRecorded" => {
+                let mut found = Vec::new();
+                evaluations(&params["record"], &mut found);
+                for (url, start, end) in found {
+                    scripts
+                        .entry(url)
+                        .or_default()
+                        .evaluations
+                        .push((start, end));
+                }
+            }
+            "ScriptProfiler.trackingComplete" => {
+                let traces = params
+                    .pointer("/samples/stackTraces")
+                    .and_then(Value::as_array);
+                for trace in traces.into_iter().flatten() {
+                    let Some(timestamp) = seconds(trace, "timestamp") else {
+                        continue;
+                    };
+                    let frames = trace["stackFrames"].as_array().into_iter().flatten();
+                    let frames = frames
+                        .map(|f| {
+                            let url = f["url"].as_str().unwrap_or("").to_string();
+                            (url, f["name"].as_str().unwrap_or("").to_string())
+                        })
+                        .collect();
+                    samples.push((timestamp, frames));
+                }
+            }
+            _ => {}
+        }
+    }
+
+    // Attribute each sample to the innermost evaluation around it, or else
+    // to the top-level code its outermost frame belongs to
+    let mut windows: Vec<(f64, f64, String)> = Vec::new();
+    for (url, script) in &scripts {
+        for &(start, end) in &script.evaluations {
+            windows.push((start, end, url.clone()));
+        }
+    }
+    for (timestamp, frames) in &samples {
+        let inside = windows
+            .iter()
+            .filter(|(start, end, _)| start <= timestamp && timestamp <= end)
+            .max_by(|a, b| a.0.total_cmp(&b.0));
+        if let Some((_, _, url)) = inside {
+            if let Some(script) = scripts.get_mut(url) {
+                script.eval_samples += 1;
+            }
+        } else if let Some((url, name)) = frames.last() {
+            if let Some(script) = scripts.get_mut(url).filter(|_| name.is_empty()) {
+                script.top_level_samples += 1;
+            }
+        }
+    }
+
+    let mut gaps: Vec<f64> = samples.windows(2).map(|w| w[1].0 - w[0].0).collect();
+    gaps.sort_by(f64::total_cmp);
+    let interval = gaps
+        .get(gaps.len() / 2)
+        .copied()
+        .unwrap_or(DEFAULT_SAMPLE_S);
+    Load {
+        scripts,
+        navigation_start,
+        interval,
+    }
+}
+
+fn print(path: &str, load: &Load) {
+    heading(&format!("Startup scripts of {}", path));
+    let (scripts, interval) = (&load.scripts, load.interval);
+
+    let start = load.navigation_start.unwrap_or_else(|| {
+        scripts
+            .values()
+            .filter_map(|s| s.requested)
+            .fold(f64::INFINITY, f64::min)
+    });
+    let ms = |seconds: f64| seconds * 1000.0;
+
+    let mut rows: Vec<(&String, &Script)> = scripts.iter().collect();
+    rows.sort_by(|a, b| {
+        let first = |s: &Script| {
+            s.requested
+                .or(s.evaluations.first().map(|e| e.0))
+                .unwrap_or(f64::INFINITY)
+        };
+        first(a.1).total_cmp(&first(b.1))
+    });
+
+    println!(
+        "    {:>8} {:>9} {:>8} {:>9} {:>10} {:>8}  script",
+        "at ms", "size", "serve ms", "eval at", "parse+jit", "run ms"
+    );
+    let mut totals = (0.0, 0.0, 0.0);
+    let mut slowest: Option<(&String, f64)> = None;
+    for (url, s) in rows {
+        let serve = match (s.requested, s.finished) {
+            (Some(r), Some(f)) => format!("{:.1}", ms(f - r)),
+            _ => "-".to_string(),
+        };
+        let window: f64 = s.evaluations.iter().map(|(a, b)| b - a).sum();
+        let (parse, run) = if s.evaluations.is_empty() {
+            ("-".to_string(), ms(s.top_level_samples as f64 * interval))
+        } else {
+            let run = (s.eval_samples as f64 * interval).min(window);
+            let parse = ms(window - run);
+            totals.1 += parse;
+            if slowest.map_or(true, |(_, ms)| parse > ms) {
+                slowest = Some((url, parse));
+            }
+            (format!("{:.1}", parse), ms(run))
+        };
+        totals.0 += s.bytes;
+        totals.2 += run;
+
+        let at = s
+            .requested
+            .map_or("-".to_string(), |r| format!("{:.1}", ms(r - start)));
+        let eval_at = s
+            .evaluations
+            .first()
+            .map_or("-".to_string(), |e| format!("{:.1}", ms(e.0 - start)));
+        println!(
+            "    {:>8} {:>9} {:>8} {:>9} {:>10} {:>8.1}  {}",
+            at,
+            bytes(s.bytes),
+            serve,
+            eval_at,
+            parse,
+            run,
+            url
+        );
+    }
+    println!(
+        "  {} script(s), {} served, {:.1} ms parse+jit, {:.1} ms top-level code",
+        scripts.len(),
+        bytes(totals.0),
+        totals.1,
+        totals.2
+    );
+
+    if let Some((url, parse)) = slowest.filter(|&(_, ms)| ms >= SLOW_PARSE_MS) {
+        println!(
+            "  {} {} spends {:.1} ms in parse+jit while evaluating; split or defer it",
+            "warning:".yellow().bold(),
+            url,
+            parse
+        );
+    }
+    println!(
+        "  {} parse+jit is the evaluation time not covered by {:.1} ms profiler samples",
+        "note:".cyan().bold(),
+        ms(interval)
+    );
+}
+
+pub fn run(mut command: Command, options: &Options) -> Result<(), String> {
+    let addr = format!("127.0.0.1:{}", options.port);
+    command.env("WEBKIT_INSPECTOR_HTTP_SERVER", &addr);
+    println!(
+        "{} Inspector at {}; the page is reloaded once it is up",
+        "       >>>".cyan(),
+        addr.dimmed()
+    );
+
+    let mut child = command
+        .spawn()
+        .map_err(|e| format!("Failed to launch target: {}", e))?;
+    let settle = Duration::from_secs(options.settle);
+    let result = inspector::wait_for_targets(&addr, LAUNCH_TIMEOUT).and_then(|paths| {
+        let mut failed = Vec::new();
+        for path in &paths {
+            // One page that fails to reload must not cost the others
+            match record_load(&addr, path, settle) {
+                Ok(events) => print(path, &analyze(&events)),
+                Err(e) => {
+                    eprintln!("{} {}: {}", "warning:".yellow().bold(), path, e);
+                    failed.push(e);
+                }
+            }
+        }
+        if failed.len() == paths.len() {
+            return Err(failed.pop().unwrap_or_default());
+        }
+        Ok(())
+    });
+
+    let _ = child.kill();
+    let _ = child.wait();
+    result
+}